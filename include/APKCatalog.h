@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "APKManager.h"
+
+// Non-owning view of one catalog entry; valid until the catalog is cleared
+struct APKView {
+    std::string_view name;
+    std::string_view packageName;
+    std::string_view filepath;
+    std::string_view version;
+    std::string_view contentHash;
+    int64_t versionCode = 0;
+    int minSdkVersion = 0;
+    int targetSdkVersion = 0;
+};
+
+// Installed-APK catalog stored as parallel columns (structure of arrays).
+// Strings are interned into fixed blocks that never move, so the columns hold
+// plain string_views and the UI can walk GetNames() without copying anything.
+// Package names are indexed by a flat open-addressing table for O(1) lookup.
+class APKCatalog {
+public:
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+
+    APKCatalog();
+    ~APKCatalog();
+
+    APKCatalog(const APKCatalog&) = delete;
+    APKCatalog& operator=(const APKCatalog&) = delete;
+
+    size_t Add(const APKInfo& info);
+    // Swap-removes: the last entry takes the removed entry's index
+    void Remove(size_t index);
+    void Clear();
+    void Reserve(size_t count);
+
+    size_t GetCount() const { return m_names.size(); }
+    bool IsEmpty() const { return m_names.empty(); }
+
+    // An entry with this package name, or kNotFound. With several, which one
+    // is unspecified: whichever the hash index probes first, which changes
+    // when Remove rebuilds the index
+    size_t FindPackage(std::string_view packageName) const;
+    size_t FindContentHash(std::string_view contentHash) const;
+
+    APKView GetView(size_t index) const;
+    APKInfo GetInfo(size_t index) const;
+
+    // Whole columns, indexed like GetView()
+    const std::vector<std::string_view>& GetNames() const { return m_names; }
+    const std::vector<std::string_view>& GetPackageNames() const { return m_packageNames; }
+    const std::vector<std::string_view>& GetFilepaths() const { return m_filepaths; }
+    const std::vector<std::string_view>& GetContentHashes() const { return m_contentHashes; }
+
+    // Bumped on every change, so callers can cache what they derive from the catalog
+    uint64_t GetGeneration() const { return m_generation; }
+
+private:
+    // Columns
+    std::vector<std::string_view> m_names;
+    std::vector<std::string_view> m_packageNames;
+    std::vector<std::string_view> m_filepaths;
+    std::vector<std::string_view> m_versions;
+    std::vector<std::string_view> m_contentHashes;
+    std::vector<int64_t> m_versionCodes;
+    std::vector<int> m_minSdkVersions;
+    std::vector<int> m_targetSdkVersions;
+    std::vector<uint64_t> m_packageHashes;
+
+    // Package index: power-of-two slots holding entry index + 1 (0 = empty)
+    std::vector<uint32_t> m_slots;
+
+    // Intern pool. Removed entries leave their strings behind until Clear(),
+    // which is fine for a catalog that only changes on install.
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    char* m_block;
+    size_t m_blockUsed;
+    std::unordered_set<std::string_view> m_interned;
+
+    uint64_t m_generation;
+
+    std::string_view Intern(std::string_view s);
+    void InsertSlot(size_t index);
+    void RebuildIndex();
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "APKManager.h"
+
+// Persistent metadata cache for an APK install directory.
+// Entries are keyed by path and validated against file size + modification time,
+// so only new or changed APKs need their manifest parsed on the next scan.
+// The on-disk form is a flat little-endian record list read with a single mapping.
+class APKIndexCache {
+public:
+    APKIndexCache();
+    ~APKIndexCache();
+
+    bool Load(const std::string& filepath);
+    bool Save(const std::string& filepath) const;
+    void Clear();
+
+    // Returns true and fills 'info' if 'path' is cached with the same size and mtime
+    bool Lookup(const std::string& path, uint64_t size, int64_t mtime, APKInfo& info) const;
+    void Store(const APKInfo& info, uint64_t size, int64_t mtime);
+    size_t GetEntryCount() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        uint64_t size;
+        int64_t mtime;
+        APKInfo info;
+    };
+
+    std::unordered_map<std::string, Entry> m_entries;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "APKManager.h"
+
+enum class CopyMethod {
+    None,
+    Reflink,        // Copy-on-write clone (btrfs, XFS, ...): no data is written
+    HardLink,       // Same-volume link: no data is written (opt-in, see InstallRequest)
+    CopyFileRange,  // In-kernel copy without a user-space round trip
+    Stream,         // Chunked write straight from the source mapping
+    Move,           // Source renamed into the store (InstallRequest::moveSource)
+    Deduplicated    // Identical APK already stored: nothing was written
+};
+
+struct InstallResult {
+    bool success = false;
+    std::string error;
+    APKInfo info;               // info.filepath is the blob in the store, info.contentHash its SHA-256
+    CopyMethod method = CopyMethod::None;
+    uint64_t bytes = 0;
+};
+
+struct InstallRequest {
+    std::string source;
+    std::string name;              // Install name recorded in the store manifest
+    std::string storeDirectory;    // The APK ends up as <storeDirectory>/<sha256>.apk
+    // Hard links share the inode with the source, so later edits to the source would
+    // show through. Only enable this for sources the caller owns (e.g. a download cache).
+    bool allowHardLink = false;
+    // Take over the source file (a loose APK dropped into the install directory):
+    // it is renamed into the store when possible and removed once stored
+    bool moveSource = false;
+    // Whether a stored blob has the source's size (APKStore::HasBlobOfSize). Only
+    // then is the source hashed before copying, to skip the copy if it is a
+    // duplicate; a duplicate stored in the meantime is still caught after the copy.
+    bool mayBeStored = true;
+};
+
+// Handle for one queued install. Progress is readable from any thread while the
+// job runs; the future becomes ready once the APK is in place (or failed).
+class InstallJob {
+public:
+    InstallJob();
+
+    const InstallRequest& GetRequest() const { return m_request; }
+    std::shared_future<InstallResult> GetFuture() const { return m_future; }
+    bool IsDone() const;
+    uint64_t GetBytesDone() const { return m_bytesDone.load(std::memory_order_relaxed); }
+    uint64_t GetBytesTotal() const { return m_bytesTotal.load(std::memory_order_relaxed); }
+    float GetProgress() const;
+
+private:
+    friend class APKInstaller;
+
+    InstallRequest m_request;
+    std::promise<InstallResult> m_promise;
+    std::shared_future<InstallResult> m_future;
+    std::atomic<uint64_t> m_bytesDone;
+    std::atomic<uint64_t> m_bytesTotal;
+};
+
+// FIFO install queue served by one background thread, so installs never block
+// the caller and concurrent installs don't fight over the same disk.
+class APKInstaller {
+public:
+    APKInstaller();
+    ~APKInstaller();
+
+    std::shared_ptr<InstallJob> Submit(const InstallRequest& request);
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::shared_ptr<InstallJob>> m_queue;
+    bool m_stopping;
+    std::thread m_thread;
+
+    void WorkerLoop();
+    static InstallResult Install(InstallJob& job);
+};
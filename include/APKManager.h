@@ -1,37 +1,98 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <filesystem>
+#include <functional>
+#include <memory>
 
 struct APKInfo {
     std::string name;
     std::string packageName;
     std::string filepath;
     std::string version;
+    std::string contentHash;    // SHA-256 of the APK; names its blob in the store
+    int64_t versionCode = 0;
+    int minSdkVersion = 0;
+    int targetSdkVersion = 0;
 };
 
+struct APKScanProgress {
+    size_t completed = 0;   // APKs whose metadata is available
+    size_t total = 0;       // APKs found so far
+    bool finished = false;
+};
+
+class APKCatalog;
+class APKIndexCache;
+class APKInstaller;
+class APKScanner;
+class APKStore;
+class InstallJob;
+class ThreadPool;
+struct InstallResult;
+
 class APKManager {
 public:
+    // Receives the entries added since the last call, on the thread that calls PollScan()
+    using ScanCallback = std::function<void(const std::vector<APKInfo>& added, const APKScanProgress& progress)>;
+    // Receives each finished install (successful or not), on the thread that calls PollInstalls()
+    using InstallCallback = std::function<void(const InstallResult& result)>;
+    
     APKManager();
     ~APKManager();
     
     // APK file operations
+    // LoadAPKAsync queues the install and returns immediately; the returned job
+    // reports copy progress and completes through its future. LoadAPK waits for it.
+    std::shared_ptr<InstallJob> LoadAPKAsync(const std::string& filepath);
     bool LoadAPK(const std::string& filepath);
-    std::vector<APKInfo> GetInstalledAPKs() const;
+    // Read-only view of the installed APKs; stays valid for the manager's lifetime
+    // and only changes inside PollScan()/PollInstalls()
+    const APKCatalog& GetCatalog() const;
     bool LaunchAPK(const std::string& packageName);
     
-    // APK info extraction (simplified - real implementation would parse AndroidManifest.xml)
-    APKInfo ExtractAPKInfo(const std::string& filepath);
+    // APK info extraction (memory-maps the APK and decodes its binary AndroidManifest.xml).
+    // Stateless, so scan workers call it concurrently.
+    static APKInfo ExtractAPKInfo(const std::string& filepath);
     
     // Installation directory
     void SetInstallDirectory(const std::string& dir);
     std::string GetInstallDirectory() const { return m_installDir; }
     
+    // Directory scans run in the background; call PollScan() once per frame to
+    // move finished entries into the installed list and fire the scan callback
+    void SetScanCallback(ScanCallback callback) { m_scanCallback = std::move(callback); }
+    void PollScan();
+    void WaitForScan();
+    bool IsScanning() const;
+    
+    // Call once per frame to add finished installs to the installed list
+    void SetInstallCallback(InstallCallback callback) { m_installCallback = std::move(callback); }
+    void PollInstalls();
+    
 private:
-    std::vector<APKInfo> m_installedAPKs;
+    // One entry per distinct APK in the store; filepath points at its blob
+    std::unique_ptr<APKCatalog> m_catalog;
     std::string m_installDir;
+    std::unique_ptr<APKIndexCache> m_indexCache;
+    std::unique_ptr<APKStore> m_store;
+    
+    // Declared before the scanner so in-flight scan tasks finish before the pool goes away
+    std::unique_ptr<ThreadPool> m_threadPool;
+    std::unique_ptr<APKScanner> m_scanner;
+    ScanCallback m_scanCallback;
+    bool m_scanReported;
+    
+    std::unique_ptr<APKInstaller> m_installer;
+    std::vector<std::shared_ptr<InstallJob>> m_pendingInstalls;
+    InstallCallback m_installCallback;
     
     void ScanInstalledAPKs();
-    std::string GetPackageNameFromPath(const std::string& filepath);
+    std::shared_ptr<InstallJob> QueueInstall(const std::string& filepath, bool moveSource);
+    void AdoptLooseAPKs();
+    std::string GetIndexPath() const;
+    std::string GetStorePath() const;
+    static std::string GetPackageNameFromPath(const std::string& filepath);
 };
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "APKManager.h"
+
+class ThreadPool;
+class APKIndexCache;
+
+// Background scan of an APK install directory.
+// A scan thread walks the directory and restores unchanged entries from the index
+// cache right away; APKs that need their manifest parsed are fanned out to the
+// thread pool. Finished entries queue up until the owner collects them with Poll(),
+// so the owner's APK list is only ever touched from its own thread.
+class APKScanner {
+public:
+    using ExtractFunc = std::function<APKInfo(const std::string&)>;
+
+    explicit APKScanner(ThreadPool& pool);
+    ~APKScanner();
+
+    // An empty indexPath disables the metadata cache (every APK is parsed)
+    void Start(const std::string& directory, const std::string& indexPath, ExtractFunc extract);
+    void Cancel();
+
+    // Moves entries finished since the last call into 'out'
+    APKScanProgress Poll(std::vector<APKInfo>& out);
+
+    // Blocks until the current scan has finished
+    void Wait();
+    bool IsRunning() const;
+
+    // Index built by the last completed scan (valid once Poll reports finished)
+    std::unique_ptr<APKIndexCache> TakeIndex();
+
+private:
+    struct ScanState;
+
+    ThreadPool& m_pool;
+    std::shared_ptr<ScanState> m_state;
+    std::thread m_thread;
+
+    static void Run(std::shared_ptr<ScanState> state, ThreadPool* pool);
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Content-addressed storage for installed APKs.
+// Every distinct APK is stored once as <directory>/<sha256>.apk; installing the
+// same file under another name only adds a name -> hash entry to manifest.json.
+// Blobs are deleted when the last name referring to them goes away.
+class APKStore {
+public:
+    APKStore();
+    ~APKStore();
+
+    // Creates the directory if needed and loads its manifest. A damaged manifest
+    // is backed up to manifest.json.bad and the names are rebuilt from the blobs
+    // (each under its hash), so no stored APK is dropped. Returns false if the
+    // store can't be used as is; Save then refuses to touch the manifest.
+    bool Open(const std::string& directory);
+    bool Save() const;
+
+    const std::string& GetDirectory() const { return m_directory; }
+    std::string GetBlobPath(const std::string& hash) const;
+    std::string GetManifestPath() const;
+
+    // Points 'name' at 'hash', a blob of 'size' bytes. Returns the hash the name
+    // used to point at if no other name refers to it any more (the caller
+    // releases that blob), else "".
+    std::string Assign(const std::string& name, const std::string& hash, uint64_t size);
+    bool IsReferenced(const std::string& hash) const;
+    // Whether a referenced blob has this size: only then can an APK be a duplicate
+    bool HasBlobOfSize(uint64_t size) const;
+    void RemoveBlob(const std::string& hash);
+
+    // Drops names whose blob has disappeared from disk; returns how many
+    size_t PruneMissing();
+
+    size_t GetNameCount() const { return m_names.size(); }
+    size_t GetBlobCount() const { return m_refCounts.size(); }
+
+private:
+    std::string m_directory;
+    bool m_readOnly;            // Damaged manifest that could not be backed up
+    std::unordered_map<std::string, std::string> m_names;  // install name -> hash
+    std::unordered_map<std::string, size_t> m_refCounts;   // hash -> number of names
+    std::unordered_map<std::string, uint64_t> m_blobSizes; // hash -> blob size, for referenced blobs
+    std::unordered_map<uint64_t, size_t> m_sizeCounts;     // blob size -> number of referenced blobs
+
+    void AddBlobSize(const std::string& hash, uint64_t size);
+    void RemoveBlobSize(const std::string& hash);
+    bool LoadManifest();
+    bool RecoverFromBlobs(const std::string& reason);
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Fields of AndroidManifest.xml that the launcher cares about
+struct ManifestInfo {
+    std::string packageName;
+    std::string versionName;
+    int64_t versionCode = 0;
+    int minSdkVersion = 0;
+    int targetSdkVersion = 0;
+    std::string label;          // Literal android:label, if the manifest has one
+    uint32_t labelResId = 0;    // android:label as a reference into resources.arsc
+};
+
+// Single-pass parser for Android binary XML (AXML) manifests.
+// Works directly on the (mapped or inflated) manifest bytes: element and attribute
+// names are compared against the string pool in place and only the final field
+// values are copied out. Parsing stops at <application>, since everything needed
+// is declared before or on it.
+class AXMLParser {
+public:
+    static bool ParseManifest(const uint8_t* data, size_t size, ManifestInfo& info);
+};
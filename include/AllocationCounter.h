@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts C++ heap allocations (every global operator new) process-wide.
+// Used by the allocation self-check (--check-frame-allocs) to prove that a
+// steady-state frame doesn't allocate. Counting is one relaxed atomic add.
+//
+// Replacing the global operator new costs every allocation that add, so it is
+// only built with EMULATOR_ALLOCATION_CHECK defined (the CMake option of the
+// same name); otherwise IsEnabled() is false and the count stays 0.
+class AllocationCounter {
+public:
+    static bool IsEnabled();
+    static uint64_t GetCount();
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+// Replace 'filepath' with 'contents' so that a crash or power loss leaves
+// either the old file or the new one, never a torn mix: the bytes go to
+// 'filepath.tmp', are flushed to disk, and the side file is renamed over the
+// original (the directory is synced too where the OS needs it). On failure
+// the original is untouched and the side file is removed.
+bool WriteFileAtomic(const std::string& filepath, const std::string& contents);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Command-line benchmark modes (see main.cpp). Each returns a process exit code.
+class Benchmarks {
+public:
+    // Cold metadata scan of every .apk in 'directory' at 1, 2, 4, ... threads,
+    // reporting throughput in APKs/sec. The index cache is bypassed.
+    static int RunAPKScan(const std::string& directory);
+
+    // Per-frame cost of the virtualized APK list (scrolling and filter-as-you-type)
+    // at 1k, 10k, ... up to 'entries' items. The cost should not grow with the size.
+    static int RunVirtualList(size_t entries);
+
+    // Guest framebuffer throughput in MB/s: the pixel converters at every SIMD
+    // level, then full streaming-texture uploads of 'frames' test-pattern frames
+    // per size and format on the software renderer.
+    static int RunGuestUpload(int frames);
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+// Embedded 5x7 bitmap font covering printable ASCII (0x20-0x7E), so text
+// rendering needs no font files or SDL_ttf. Each glyph is five column bytes,
+// least significant bit at the top row.
+class BitmapFont {
+public:
+    static constexpr int kGlyphWidth = 5;
+    static constexpr int kGlyphHeight = 7;
+    static constexpr int kFirstChar = 0x20;
+    static constexpr int kLastChar = 0x7E;
+    static constexpr int kGlyphCount = kLastChar - kFirstChar + 1;
+
+    // Glyph index for 'c'; characters outside the font map to '?'
+    static int GetGlyphIndex(char c);
+    // Five column bytes for glyph 'index'
+    static const uint8_t* GetGlyphColumns(int index);
+};
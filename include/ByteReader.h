@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Non-owning view of a byte range
+struct ByteView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// Little-endian loads for on-disk formats (ZIP, Android binary XML / resources).
+// Byte-wise so they are safe on unaligned data and on any host endianness.
+inline uint16_t ReadLE16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t ReadLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) |
+           (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t ReadLE64(const uint8_t* p) {
+    return static_cast<uint64_t>(ReadLE32(p)) | (static_cast<uint64_t>(ReadLE32(p + 4)) << 32);
+}
@@ -1,20 +1,93 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <string>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
+// The settings schema: value kind, Settings field, JSON key, default.
+// Everything else (the typed struct, the key table, parsing and the default
+// config) is generated from this list, so a new setting is one line here.
+#define EMULATOR_SETTINGS(X) \
+    X(Int,    windowWidth,  "window_width",  1280) \
+    X(Int,    windowHeight, "window_height", 720) \
+    X(Bool,   fullscreen,   "fullscreen",    false) \
+    X(Bool,   vsync,        "vsync",         true) \
+    X(Int,    targetFps,    "target_fps",    60) \
+    X(String, framePacing,  "frame_pacing",  "") \
+    X(Int,    tickRate,     "tick_rate",     60) \
+    X(String, guestScaling, "guest_scaling", "integer") \
+    X(String, guestFilter,  "guest_filter",  "nearest")
+
+enum class SettingKind { Int, Bool, String };
+
+using SettingInt = int;
+using SettingBool = bool;
+using SettingString = std::string;
+
+// Every known setting as a plain field, parsed once per load. Hot paths read
+// these instead of looking keys up in the JSON document.
+struct Settings {
+#define EMULATOR_SETTING_FIELD(kind, field, key, value) Setting##kind field = value;
+    EMULATOR_SETTINGS(EMULATOR_SETTING_FIELD)
+#undef EMULATOR_SETTING_FIELD
+};
+
+struct SettingKey {
+    const char* key;
+    SettingKind kind;
+};
+
+constexpr SettingKey kSettingKeys[] = {
+#define EMULATOR_SETTING_KEY(kind, field, key, value) { key, SettingKind::kind },
+    EMULATOR_SETTINGS(EMULATOR_SETTING_KEY)
+#undef EMULATOR_SETTING_KEY
+};
+
+// JSON configuration. The document is kept whole, so keys this build doesn't
+// know (newer or hand-added settings) survive a load/save round trip; the
+// known ones are mirrored into Settings on load and on every Set*.
+// Changes are saved by a background writer once they have been quiet for
+// kSaveDelay, so a burst of Set* calls costs one write and never a frame.
+// Every write goes to a temp file that is synced and then renamed over the
+// config, so a crash leaves either the old file or the new one.
+// Use from one thread; only the writer runs beside it.
 class ConfigManager {
 public:
     ConfigManager();
     ~ConfigManager();
     
     bool LoadConfig(const std::string& filepath = "config.json");
+    // Write now, on the calling thread
     bool SaveConfig(const std::string& filepath = "config.json");
+    // Barrier: block until every change made so far has been written by the
+    // background writer. Returns false if the last write failed.
+    bool Flush();
+    uint64_t GetWriteCount() const;
+    
+    // The whole configuration as compact JSON, e.g. for input recordings
+    std::string GetSnapshot() const;
+    bool LoadSnapshot(const std::string& snapshot);
+    // Replace the configuration with an already parsed document (not saved)
+    void LoadDocument(const json& config);
+    const json& GetDocument() const { return m_config; }
+    const std::string& GetConfigPath() const { return m_configPath; }
+    // True while a change is waiting for the background writer
+    bool HasPendingChanges() const;
     
-    // Getters
+    const Settings& GetSettings() const { return m_settings; }
+    // The schema entry for 'key', or nullptr if it isn't a known setting
+    static const SettingKey* FindSettingKey(const std::string& key);
+    // Every known setting read from 'config'; missing or mistyped keys keep their defaults
+    static Settings ReadSettings(const json& config);
+    
+    // Getters (any key, known or not)
     std::string GetString(const std::string& key, const std::string& defaultValue = "") const;
     int GetInt(const std::string& key, int defaultValue = 0) const;
     float GetFloat(const std::string& key, float defaultValue = 0.0f) const;
@@ -27,17 +100,56 @@ public:
     void SetBool(const std::string& key, bool value);
     
     // Window settings
-    int GetWindowWidth() const { return GetInt("window_width", 1280); }
-    int GetWindowHeight() const { return GetInt("window_height", 720); }
-    bool GetFullscreen() const { return GetBool("fullscreen", false); }
+    int GetWindowWidth() const { return m_settings.windowWidth; }
+    int GetWindowHeight() const { return m_settings.windowHeight; }
+    bool GetFullscreen() const { return m_settings.fullscreen; }
+    
+    // Frame pacing: "frame_pacing" is fixed/uncapped/vsync/vrr; when empty,
+    // "vsync" picks between vsync and fixed pacing at "target_fps"
+    bool GetVSync() const { return m_settings.vsync; }
+    int GetTargetFPS() const { return m_settings.targetFps; }
+    const std::string& GetFramePacing() const { return m_settings.framePacing; }
+    
+    // Emulation ticks per second (independent of the render frame rate)
+    int GetTickRate() const { return m_settings.tickRate; }
+    
+    // Guest display: "guest_scaling" is integer/aspect/stretch, "guest_filter" nearest/linear
+    const std::string& GetGuestScaling() const { return m_settings.guestScaling; }
+    const std::string& GetGuestFilter() const { return m_settings.guestFilter; }
     
     void SetWindowWidth(int width) { SetInt("window_width", width); }
     void SetWindowHeight(int height) { SetInt("window_height", height); }
     void SetFullscreen(bool fullscreen) { SetBool("fullscreen", fullscreen); }
     
 private:
+    static constexpr std::chrono::milliseconds kSaveDelay{500};
+    
     json m_config;
+    Settings m_settings;
     std::string m_configPath;
     
+    // Background saving. m_mutex guards changes to m_config and m_configPath
+    // (reads on the owning thread need no lock; it is the only writer) and
+    // the state below.
+    mutable std::mutex m_mutex;
+    std::mutex m_fileMutex;         // One file replacement at a time
+    std::condition_variable m_wake;
+    std::condition_variable m_saved;
+    std::thread m_writer;           // Started by the first change
+    uint64_t m_changeSerial;        // Bumped by every Set*
+    uint64_t m_savedSerial;         // Newest change the writer has handled
+    std::chrono::steady_clock::time_point m_lastChange;
+    bool m_flushRequested;
+    bool m_stopping;
+    bool m_lastWriteOk;
+    uint64_t m_writeCount;
+    
     void CreateDefaultConfig();
+    // Refresh m_settings from m_config: every field, or just the one for 'key'
+    void ParseSettings();
+    void ParseSetting(const std::string& key);
+    // Call with m_mutex held after changing m_config
+    void MarkChanged();
+    void WriterLoop();
+    bool WriteConfigFile(const std::string& filepath, const std::string& contents);
 };
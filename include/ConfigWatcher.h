@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConfigManager.h"
+
+// One parsed state of the config file. Never changed once published.
+struct ConfigSnapshot {
+    uint64_t generation = 0;    // 1 for the config loaded at startup, +1 per reload
+    json document;
+    Settings settings;
+};
+
+// Watches the config file and re-parses it off-thread whenever it changes on
+// disk, so edits apply without a restart.
+// Change notifications come from inotify on Linux and a directory change
+// notification on Windows; elsewhere (or if those fail) the file is polled.
+// The directory is watched rather than the file, since editors and our own
+// writer replace the file by renaming a new one over it.
+//
+// Each reload is published as an immutable ConfigSnapshot through an atomic
+// pointer. Readers (render and simulation threads) take no lock: Acquire is
+// one load and one store. The watcher thread frees a replaced snapshot once
+// every reader has acquired a newer one, so a reader may keep using its
+// snapshot until its next Acquire.
+class ConfigWatcher {
+public:
+    static constexpr int kMaxReaders = 4;
+
+    // 'document' is the config as loaded at startup (generation 1)
+    ConfigWatcher(const std::string& filepath, const json& document);
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    void Start();
+    void Stop();
+
+    // Claim a reader slot; call once per reading thread, before Start.
+    // Returns -1 if all slots are taken.
+    int RegisterReader();
+    // The newest snapshot. The one this reader acquired before may be freed
+    // from here on, so it must not be used after this call.
+    const ConfigSnapshot& Acquire(int reader);
+
+    uint64_t GetGeneration() const { return m_generation.load(); }
+
+private:
+    // Edits often arrive as several writes; reload once they have been quiet this long
+    static constexpr std::chrono::milliseconds kSettleDelay{50};
+    static constexpr std::chrono::milliseconds kPollInterval{500};
+
+    // Modification time and size: enough to tell a changed file from a touched directory
+    struct FileStamp {
+        int64_t modified = 0;
+        uint64_t size = 0;
+        bool exists = false;
+
+        bool operator==(const FileStamp& other) const {
+            return modified == other.modified && size == other.size && exists == other.exists;
+        }
+        bool operator!=(const FileStamp& other) const { return !(*this == other); }
+    };
+
+    std::filesystem::path m_path;
+    std::atomic<bool> m_stopping;
+    std::thread m_thread;
+
+    // Change notification and the handle Stop signals to wake the thread
+#ifdef _WIN32
+    void* m_notifier;       // Directory change notification, or null
+    void* m_wakeEvent;
+#else
+    int m_notifier;         // inotify descriptor, or -1
+    int m_wakePipe[2];
+#endif
+
+    std::atomic<const ConfigSnapshot*> m_current;
+    std::atomic<uint64_t> m_generation;
+    // Generation each reader last acquired (0 = not yet)
+    std::atomic<uint64_t> m_readerGenerations[kMaxReaders];
+    std::atomic<int> m_readerCount;
+
+    // Owned by the watcher thread (and the destructor, once it has stopped)
+    std::vector<std::unique_ptr<ConfigSnapshot>> m_snapshots;
+    FileStamp m_stamp;
+
+    void ThreadLoop();
+    bool OpenNotifier();
+    void CloseNotifier();
+    // Block until the config may have changed (without a notifier: until
+    // kPollInterval has passed). Returns false once stopping.
+    bool WaitForChange();
+    // Re-read the file if its stamp moved; publish it if it parses to something new
+    void Reload();
+    void Publish(std::unique_ptr<ConfigSnapshot> snapshot);
+    // Free replaced snapshots no reader can still hold
+    void Reclaim();
+    FileStamp ReadStamp() const;
+};
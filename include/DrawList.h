@@ -0,0 +1,61 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// SDL_Vertex and SDL_RenderGeometry; CMake asks for the same version
+#if !SDL_VERSION_ATLEAST(2, 0, 18)
+#error "SDL 2.0.18 or newer is required"
+#endif
+
+class TextRenderer;
+
+// Retained list of UI primitives.
+// A widget records its rectangles and text once; the list keeps the resulting
+// vertices and replays them with one SDL_RenderGeometry call per texture run
+// until the widget clears and rebuilds it. Colour is a vertex attribute and
+// shapes sample the font atlas's solid cell, so consecutive shapes and text
+// merge into the same batch regardless of colour.
+class DrawList {
+public:
+    explicit DrawList(TextRenderer& text);
+    ~DrawList();
+
+    void Clear();
+
+    void AddRect(int x, int y, int w, int h, SDL_Color color);
+    // One pixel wide border, inside the rectangle
+    void AddRectOutline(int x, int y, int w, int h, SDL_Color color);
+    void AddText(std::string_view text, int x, int y, SDL_Color color);
+    // Primitives added while a clip rectangle is set are cut to it; nullptr clears it
+    void SetClipRect(const SDL_Rect* clip);
+
+    // Draw the recorded primitives; returns the number of draw calls issued
+    int Submit(SDL_Renderer* renderer) const;
+
+    bool IsEmpty() const { return m_vertices.empty(); }
+    size_t GetVertexCount() const { return m_vertices.size(); }
+    size_t GetBatchCount() const { return m_batches.size(); }
+
+private:
+    // A run of quads that sample the same texture
+    struct Batch {
+        SDL_Texture* texture;
+        size_t firstVertex;
+        size_t vertexCount;
+    };
+
+    TextRenderer& m_text;
+    std::vector<SDL_Vertex> m_vertices;
+    std::vector<int> m_indices;     // Quad index pattern, sized for the largest batch
+    std::vector<Batch> m_batches;
+    bool m_clipped;
+    SDL_FRect m_clip;
+
+    // Cut the quads appended since 'firstVertex' to the clip rectangle
+    void ClipQuads(size_t firstVertex);
+    // Extend or start the batch for vertices appended since the last call
+    void CloseBatch(SDL_Texture* texture, size_t firstVertex);
+};
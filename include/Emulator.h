@@ -2,11 +2,23 @@
 
 #include <SDL2/SDL.h>
 #include <string>
+#include <vector>
 #include <memory>
 #include <chrono>
+#include <future>
 #include "ConfigManager.h"
+#include "ConfigWatcher.h"
 #include "KeyMapper.h"
 #include "APKManager.h"
+#include "FrameArena.h"
+#include "FramePacer.h"
+#include "FrameTelemetry.h"
+#include "GuestFramebuffer.h"
+#include "InputLatency.h"
+#include "InputRecording.h"
+#include "InputScript.h"
+#include "Simulation.h"
+#include "TestPattern.h"
 #include "UI.h"
 
 class Emulator {
@@ -20,35 +32,125 @@ public:
     
     bool IsRunning() const { return m_running; }
     
+    // Self-check: runs 'frames' steady-state frames with every overlay on and
+    // fails unless none of them made a heap allocation. Returns an exit code.
+    int RunAllocationCheck(int frames);
+    
+    // Headless run (benchmarks, CI): 'frames' uncapped frames of the full loop,
+    // then the frame-time statistics. With 'hashFrames' the run is deterministic
+    // (one simulation tick per frame, no measurement overlays) and every rendered
+    // frame is hashed for regression checks. Returns an exit code.
+    int RunHeadless(int frames, bool hashFrames);
+    
+    // Scripted key input, injected at the start of every frame (see InputScript).
+    // An empty path loads the built-in script.
+    bool LoadInputScript(const std::string& filepath);
+    
+    // Record this session's input (with the config and view state it started
+    // from) to 'filepath'; call after Initialize
+    bool StartRecording(const std::string& filepath);
+    
+    // Replay a recording: load it before Initialize, which then uses the
+    // recorded config, and run it with RunReplay. Every frame takes its time
+    // step and simulation ticks from the recording, so replays are identical
+    // run to run; 'fast' drops pacing and runs as fast as possible. Prints the
+    // frame-time statistics like RunHeadless. Returns an exit code.
+    bool LoadReplay(const std::string& filepath);
+    int RunReplay(bool fast, bool hashFrames);
+    
+    // Write the startup trace (Chrome trace-event JSON) to 'filepath' once the
+    // first frame is on screen and the APK catalog has loaded; call before Initialize.
+    // The time to first frame is printed either way.
+    void SetStartupTracePath(const std::string& filepath);
+    
 private:
+    void RunFrame();
     void ProcessEvents();
     void Update(float deltaTime);
     void Render();
-    void UpdateFPS(float deltaTime);
+    void UpdateOutputSize();
+    void HandleInputEvent(const SDL_Event& event);
+    void HandleKeyEvent(const SDL_KeyboardEvent& key, std::chrono::steady_clock::time_point timestamp);
+    void HandleAction(Action action);
+    void DumpTelemetry();
+    void PrintRunReport(const char* title, int frames, double seconds);
+    void HashFrame();
+    bool ReportFrameHashes();
+    bool WriteFrameHashes(const std::string& filepath) const;
+    uint8_t GetViewFlags() const;
+    void SetViewFlags(uint8_t flags);
+    // Take over the APK manager from its startup worker once it exists; with
+    // 'wait', block until it does. False while it is still being created.
+    bool AdoptAPKManager(bool wait);
+    void WaitForAPKScan();
+    void WriteStartupTrace();
+    PacingMode GetConfiguredPacing() const;
+    // Apply a reloaded config to the running window, renderer and pacer
+    void ApplyConfig(const ConfigSnapshot& config);
     
     SDL_Window* m_window;
     SDL_Renderer* m_renderer;
     bool m_running;
     
-    // FPS tracking
-    float m_fps;
+    // Frame timing
     float m_frameTime;
     std::chrono::high_resolution_clock::time_point m_lastFrameTime;
-    std::chrono::high_resolution_clock::time_point m_fpsUpdateTime;
-    int m_frameCount;
+    std::unique_ptr<FrameTelemetry> m_telemetry;
+    FrameStats m_frameStats;
+    std::unique_ptr<FrameArena> m_frameArena;
+    uint64_t m_frameIndex;
+    
+    // Key press to present latency; guest presses are matched to frames by
+    // their position in the guest's input sequence
+    std::unique_ptr<InputLatencyTracker> m_inputLatency;
+    std::unique_ptr<InputScript> m_inputScript;
+    uint64_t m_guestInputsPushed;
+    
+    // Input recording / replay
+    std::unique_ptr<InputRecorder> m_inputRecorder;
+    std::unique_ptr<InputReplay> m_inputReplay;
+    uint64_t m_recordedTick;    // Simulation tick the last recorded frame rendered
+    
+    // Deterministic runs (hashed headless runs, replays): fixed timestep,
+    // optionally a hash per rendered frame
+    bool m_deterministic;
+    bool m_hashFrames;
+    std::vector<uint8_t> m_readback;
+    std::vector<uint64_t> m_frameHashes;
     
     // Frame pacing
-    const float m_targetFPS = 60.0f;
-    const float m_targetFrameTime = 1.0f / m_targetFPS;
+    std::unique_ptr<FramePacer> m_framePacer;
+    double m_displayHz;
+    
+    // Config file edits while running (interactive sessions only)
+    std::unique_ptr<ConfigWatcher> m_configWatcher;
+    int m_configReader;
+    uint64_t m_configGeneration;
     
     // Components
     std::unique_ptr<ConfigManager> m_configManager;
     std::unique_ptr<KeyMapper> m_keyMapper;
     std::unique_ptr<APKManager> m_apkManager;
+    std::future<std::unique_ptr<APKManager>> m_apkManagerLoad;
+    std::unique_ptr<Simulation> m_simulation;
     std::unique_ptr<UI> m_ui;
+    std::unique_ptr<GuestFramebuffer> m_guestFramebuffer;
+    std::unique_ptr<TestPattern> m_testPattern;
+    uint64_t m_guestTick;       // Tick of the frame last uploaded
+    
+    // Startup: time to first frame (0 until then), and the trace once the
+    // catalog has loaded too
+    uint64_t m_firstFrameMicros;
+    bool m_catalogReady;
+    std::string m_startupTracePath;
+    bool m_startupTraceWritten;
+    
+    // Simulation state interpolated to the current frame
+    SimulationState m_renderState;
     
     // State
     bool m_showDebugOverlay;
     bool m_showAboutScreen;
     bool m_showMainMenu;
+    bool m_showTestPattern;
 };
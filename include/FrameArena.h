@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FRAME_ARENA_PRINTF(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#define FRAME_ARENA_PRINTF(fmt, args)
+#endif
+
+// Bump allocator for data that lives until the end of the frame.
+// The block is allocated once; Reset() at the top of each frame makes all of it
+// available again, so per-frame text and scratch arrays never touch the heap.
+// When the block runs out, allocations fail (nullptr / truncated text) instead
+// of growing, and the overflow is counted so it shows up in the debug overlay.
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity = 64 * 1024);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // Uninitialized storage for 'count' trivially destructible objects
+    template <typename T>
+    T* AllocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // printf-style formatting into the arena; the view is valid until Reset()
+    std::string_view Format(const char* format, ...) FRAME_ARENA_PRINTF(2, 3);
+
+    void Reset();
+
+    size_t GetUsed() const { return m_used; }
+    size_t GetCapacity() const { return m_capacity; }
+    size_t GetHighWater() const { return m_highWater; }
+    uint64_t GetOverflowCount() const { return m_overflows; }
+
+private:
+    std::unique_ptr<unsigned char[]> m_block;
+    size_t m_capacity;
+    size_t m_used;
+    size_t m_highWater;
+    uint64_t m_overflows;
+};
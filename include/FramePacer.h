@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+enum class PacingMode {
+    Fixed,      // Pace to target_fps ourselves; no vsync
+    Uncapped,   // Render as fast as possible
+    VSync,      // The display paces presents; only deadlines are tracked
+    VRR         // Variable refresh: pace just under the display's maximum rate, no vsync
+};
+
+// Frame pacer built on steady_clock deadlines.
+// Waiting sleeps in coarse steps until the scheduler's observed oversleep would
+// risk the deadline, then spins the last stretch, so frames land within
+// microseconds of their deadline instead of whole milliseconds late.
+// Deadlines advance by exactly one period, so rounding never accumulates.
+class FramePacer {
+public:
+    FramePacer();
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // targetFps <= 0 means uncapped; displayHz is the current display refresh
+    // rate (0 if unknown) and is used by the VSync and VRR modes
+    void Configure(PacingMode mode, double targetFps, double displayHz);
+
+    // "fixed", "uncapped", "vsync" or "vrr"; anything else yields 'fallback'
+    static PacingMode ParseMode(const std::string& name, PacingMode fallback);
+    static const char* GetModeName(PacingMode mode);
+
+    // Call once per frame after presenting. Blocks until the next frame is due.
+    void WaitForNextFrame();
+
+    PacingMode GetMode() const { return m_mode; }
+    double GetTargetFrameSeconds() const;
+    uint64_t GetFrameCount() const { return m_frameCount; }
+    // Frames that were not ready by their deadline
+    uint64_t GetMissedDeadlines() const { return m_missedDeadlines; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    PacingMode m_mode;
+    Clock::duration m_period;
+    Clock::time_point m_deadline;
+    Clock::time_point m_lastFrame;
+    bool m_started;
+
+    // Longest oversleep seen recently; the spin phase starts this far before the deadline
+    Clock::duration m_spinThreshold;
+
+    uint64_t m_frameCount;
+    uint64_t m_missedDeadlines;
+
+    void SleepUntil(Clock::time_point deadline);
+};
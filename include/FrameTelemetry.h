@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+enum class FramePhase {
+    Events,
+    Update,
+    Render,
+    Present,
+    Sleep,
+    Count
+};
+
+struct FrameSample {
+    uint64_t frame = 0;
+    uint32_t phaseMicros[static_cast<size_t>(FramePhase::Count)] = {};
+    uint32_t totalMicros = 0;
+};
+
+// Log-linear histogram of microsecond durations (HDR histogram style): exact
+// below 64 us, then 32 sub-buckets per power of two, so any percentile is
+// within ~3% of the true value with constant memory and O(1) recording.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void Record(uint64_t micros);
+    void Reset();
+
+    uint64_t GetCount() const { return m_count; }
+    uint64_t GetMax() const { return m_max; }
+    double GetMean() const;
+    // q in [0, 1]
+    uint64_t GetPercentile(double q) const;
+    // Mean of the slowest 'fraction' of samples (e.g. 0.01 for the "1% low")
+    double GetTailMean(double fraction) const;
+
+private:
+    static constexpr int kSubBucketBits = 6;
+    static constexpr size_t kBucketCount = 1024;
+
+    std::array<uint32_t, kBucketCount> m_buckets;
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint64_t m_max;
+
+    static size_t GetBucketIndex(uint64_t micros);
+    static uint64_t GetBucketValue(size_t index);
+};
+
+struct FrameStats {
+    double fps = 0.0;           // Over the last second
+    double p50Ms = 0.0;
+    double p99Ms = 0.0;
+    double p999Ms = 0.0;
+    double maxMs = 0.0;
+    double onePercentLowFps = 0.0;
+    uint64_t frames = 0;
+};
+
+// Per-frame phase timings. The frame thread records into a fixed ring buffer
+// (the latest kCapacity frames, published with an atomic head so another thread
+// may read behind it) and into one histogram per phase plus one for whole frames.
+class FrameTelemetry {
+public:
+    static constexpr size_t kCapacity = 4096;
+
+    FrameTelemetry();
+    ~FrameTelemetry();
+
+    // Call at the start of the frame, after each phase, and at the end
+    void BeginFrame();
+    void EndPhase(FramePhase phase);
+    void EndFrame();
+
+    FrameStats GetStats() const;
+    const LatencyHistogram& GetHistogram(FramePhase phase) const;
+    const LatencyHistogram& GetFrameHistogram() const { return m_frameHistogram; }
+    uint64_t GetFrameCount() const { return m_head.load(std::memory_order_acquire); }
+    void Reset();
+
+    // Ring contents as CSV (one row per frame) and the percentile summary as JSON
+    bool WriteCSV(const std::string& filepath) const;
+    bool WriteJSON(const std::string& filepath) const;
+
+    static const char* GetPhaseName(FramePhase phase);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::unique_ptr<FrameSample[]> m_ring;
+    std::atomic<uint64_t> m_head;   // Frames recorded so far
+
+    LatencyHistogram m_phaseHistograms[static_cast<size_t>(FramePhase::Count)];
+    LatencyHistogram m_frameHistogram;
+
+    FrameSample m_current;
+    Clock::time_point m_frameStart;
+    Clock::time_point m_phaseStart;
+    bool m_inFrame;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PixelConvert.h"
+
+// One frame of guest output; 'pixels' only has to stay valid during Upload()
+struct GuestFrame {
+    const void* pixels;
+    int width;
+    int height;
+    int pitch;                  // Bytes per row
+    GuestPixelFormat format;
+};
+
+// How the guest image is fitted into the content area
+enum class GuestScaleMode {
+    Integer,    // Largest whole multiple that fits (pixel-exact), aspect-fit if even 1x does not
+    Aspect,     // Largest size that fits with the guest's aspect ratio
+    Stretch     // Fill the area
+};
+
+// Guest framebuffer presented in the content area.
+// Frames are converted to RGBA straight into a locked SDL_TEXTUREACCESS_STREAMING
+// texture. There are two textures used alternately, so the frame being written
+// never is the one the GPU may still be reading for the previous present, and
+// the upload path allocates nothing once the textures exist.
+// With software scaling on (meant for the software renderer, whose scaled
+// copies are slow), the upload also does the integer upscale with the SIMD row
+// scaler and the texture is drawn 1:1.
+class GuestFramebuffer {
+public:
+    explicit GuestFramebuffer(SDL_Renderer* renderer);
+    ~GuestFramebuffer();
+
+    GuestFramebuffer(const GuestFramebuffer&) = delete;
+    GuestFramebuffer& operator=(const GuestFramebuffer&) = delete;
+
+    // Convert and upload a frame, then make it the one Draw() shows
+    bool Upload(const GuestFrame& frame);
+    // Draw the latest frame fitted into 'area'; returns false if there is none
+    bool Draw(const SDL_Rect& area);
+    // Where the frame lands inside 'area' with the current scale mode
+    SDL_Rect GetDestRect(const SDL_Rect& area) const;
+
+    void SetScaleMode(GuestScaleMode mode) { m_scaleMode = mode; }
+    GuestScaleMode GetScaleMode() const { return m_scaleMode; }
+    void SetLinearFilter(bool linear);
+    void SetSoftwareScaling(bool enabled);
+
+    // Drop the textures (renderer device reset); the next upload recreates them
+    void ReleaseTextures();
+
+    bool HasFrame() const { return m_front >= 0; }
+    int GetWidth() const { return m_frameWidth; }
+    int GetHeight() const { return m_frameHeight; }
+    int GetSoftwareScale() const { return m_textureScale; }
+    uint64_t GetUploadCount() const { return m_uploads; }
+    // Bytes written into textures so far
+    uint64_t GetUploadedBytes() const { return m_uploadedBytes; }
+
+    // Config values "integer", "aspect", "stretch"; anything else gives 'fallback'
+    static GuestScaleMode ParseScaleMode(const std::string& name, GuestScaleMode fallback);
+    static const char* GetScaleModeName(GuestScaleMode mode);
+
+private:
+    SDL_Renderer* m_renderer;
+    SDL_Texture* m_textures[2];
+    int m_front;                // Texture holding the latest frame, -1 if none
+    int m_textureWidth;
+    int m_textureHeight;
+    int m_textureScale;         // Software upscale baked into the textures
+    int m_maxTextureSize;
+
+    int m_frameWidth;
+    int m_frameHeight;
+    GuestScaleMode m_scaleMode;
+    bool m_linearFilter;
+    bool m_softwareScaling;
+    int m_wantedScale;          // Software upscale for the area last drawn into
+
+    std::vector<uint32_t> m_rowBuffer;     // One converted row before software upscaling
+    uint64_t m_uploads;
+    uint64_t m_uploadedBytes;
+
+    bool EnsureTextures(int width, int height, int scale);
+    void ApplyFilter();
+    int GetIntegerScale(const SDL_Rect& area) const;
+};
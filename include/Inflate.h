@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Minimal raw DEFLATE (RFC 1951) decoder for ZIP entries.
+// The caller knows the uncompressed size from the ZIP central directory,
+// so output goes straight into a preallocated buffer with no intermediate window.
+// Returns false on corrupt input or if the output does not fit in dstSize.
+bool InflateRaw(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize, size_t* written);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "FrameTelemetry.h"
+
+// Points in the frame an input event is measured at. Queue comes from SDL's
+// millisecond event timestamp; the others are steady-clock times since the pump.
+enum class LatencyStage {
+    Queue,      // Time spent in SDL's queue before ProcessEvents pumped it (1 ms resolution)
+    Update,     // End of the Update phase that followed
+    Render,     // End of the first Render that reflects it
+    Present,    // SDL_RenderPresent returned for that frame (input-to-photon proxy)
+    Count
+};
+
+// Follows key presses from the moment they are pumped to the present of the
+// first frame that shows their effect. Host input (menu, overlays) takes effect
+// in the frame that pumped it; guest input only once the simulation snapshot
+// the frame renders has applied it, which is tracked by the guest's input-event
+// sequence number. Fixed capacity, no allocation.
+class InputLatencyTracker {
+public:
+    static constexpr size_t kMaxPending = 64;
+
+    InputLatencyTracker();
+
+    // 'pumpedAt' is taken as the event leaves SDL's queue; 'sdlTimestamp' is the
+    // event's SDL_GetTicks() stamp (ms), used only for the Queue stage.
+    // 'guestSequence' is the guest input-event count at which the guest has
+    // applied it, 0 for host input
+    void OnEventPumped(uint32_t sdlTimestamp, std::chrono::steady_clock::time_point pumpedAt,
+                       uint64_t guestSequence);
+    void OnUpdateDone(std::chrono::steady_clock::time_point now);
+    // 'guestEvents' is the input-event count of the snapshot the frame rendered
+    void OnRenderDone(std::chrono::steady_clock::time_point now, uint64_t guestEvents);
+    void OnPresentDone(std::chrono::steady_clock::time_point now);
+
+    const LatencyHistogram& GetHistogram(LatencyStage stage) const {
+        return m_histograms[static_cast<size_t>(stage)];
+    }
+    // Events that reached the Present stage
+    uint64_t GetEventCount() const { return GetHistogram(LatencyStage::Present).GetCount(); }
+    // Events dropped because too many were in flight
+    uint64_t GetOverflowCount() const { return m_overflows; }
+    void Reset();
+
+    static const char* GetStageName(LatencyStage stage);
+
+private:
+    struct Pending {
+        std::chrono::steady_clock::time_point pumpedAt;
+        uint64_t guestSequence;
+        bool updated;
+        bool rendered;
+    };
+
+    std::array<Pending, kMaxPending> m_pending;
+    size_t m_pendingCount;
+    uint64_t m_overflows;
+    LatencyHistogram m_histograms[static_cast<size_t>(LatencyStage::Count)];
+
+    void Record(LatencyStage stage, const Pending& pending, std::chrono::steady_clock::time_point now);
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Input recordings: a session's input stream, frame by frame, for replaying
+// against the fixed-timestep loop.
+//
+// File layout (little-endian):
+//     header   "EMIR", u32 version, u32 output width, u32 output height,
+//              u32 config length, config JSON
+//     records  u8 tag, then varint fields:
+//              key    scancode, flags (1 = pressed, 2 = repeat), offset
+//              text   length, UTF-8 bytes, offset
+//              wheel  zigzag y, offset
+//              view   overlay/menu flags at the start of the next frame
+//              frame  time step (us), simulation ticks
+// Input and view records belong to the frame record that follows them; the
+// offsets are microseconds from the start of that frame to the event's pump.
+
+// One frame of a recording
+struct RecordedFrame {
+    uint32_t deltaMicros = 0;   // Time step the frame ran with
+    uint32_t ticks = 0;         // Simulation ticks its snapshot advanced by
+    uint32_t firstEvent = 0;
+    uint32_t eventCount = 0;
+    int viewFlags = -1;         // Host view state to start from, -1 = unchanged
+};
+
+// Appends records to a buffer and writes it out in large chunks, so recording
+// costs the frame a few bytes of copying
+class InputRecorder {
+public:
+    InputRecorder();
+    ~InputRecorder();
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    bool Begin(const std::string& filepath, const std::string& config, int outputWidth, int outputHeight);
+    // Key, text and wheel events; anything else is ignored
+    void RecordEvent(const SDL_Event& event, uint32_t offsetMicros);
+    void RecordView(uint8_t viewFlags);
+    void EndFrame(uint32_t deltaMicros, uint32_t ticks);
+    // Flush and close; returns false if anything failed to write
+    bool Finish();
+
+    bool IsRecording() const { return m_file != nullptr; }
+    uint64_t GetFrameCount() const { return m_frames; }
+    uint64_t GetByteCount() const { return m_written + m_buffer.size(); }
+    const std::string& GetPath() const { return m_path; }
+
+private:
+    static constexpr size_t kFlushSize = 64 * 1024;
+
+    std::FILE* m_file;
+    std::string m_path;
+    std::string m_buffer;
+    uint64_t m_frames;
+    uint64_t m_written;
+    bool m_failed;
+
+    void Flush();
+};
+
+// A loaded recording, replayed one frame at a time
+class InputReplay {
+public:
+    InputReplay();
+    ~InputReplay();
+
+    bool Load(const std::string& filepath);
+
+    const std::string& GetConfig() const { return m_config; }
+    int GetOutputWidth() const { return m_outputWidth; }
+    int GetOutputHeight() const { return m_outputHeight; }
+    size_t GetFrameCount() const { return m_frames.size(); }
+
+    // Move to the next frame; false once every frame has been played
+    bool NextFrame();
+    bool IsFinished() const { return m_played >= m_frames.size(); }
+    size_t GetFramesPlayed() const { return m_played; }
+    // The frame NextFrame moved to, and its input events
+    const RecordedFrame& GetFrame() const { return m_frames[m_played - 1]; }
+    const SDL_Event& GetEvent(size_t index) const { return m_events[index]; }
+
+private:
+    std::string m_config;
+    int m_outputWidth;
+    int m_outputHeight;
+    std::vector<RecordedFrame> m_frames;
+    std::vector<SDL_Event> m_events;
+    size_t m_played;
+};
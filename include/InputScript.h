@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Synthetic key input for benchmarks. A script is a list of steps, one per line:
+//
+//     <frame> <key> <down|up|tap> [every <frames>]
+//
+// Key names are SDL scancode names ("Up", "F3", "Return"); a tap is a press on
+// <frame> and the release one frame later; 'every' repeats the step. Blank
+// lines and '#' comments are ignored. Inject pushes the due events into SDL's
+// queue, so they take the same path through ProcessEvents as real keys.
+class InputScript {
+public:
+    InputScript();
+    ~InputScript();
+
+    bool Load(const std::string& filepath);
+    // Built-in script: closes the main menu, then exercises guest and host keys
+    void LoadDefault();
+
+    // Push the events due on 'frame' (frames counted from 0)
+    void Inject(uint64_t frame);
+
+    size_t GetStepCount() const { return m_steps.size(); }
+
+private:
+    enum class StepKind { Down, Up, Tap };
+
+    struct Step {
+        uint64_t frame;
+        uint64_t every;         // 0 = once
+        SDL_Scancode scancode;
+        StepKind kind;
+    };
+
+    std::vector<Step> m_steps;
+
+    bool Parse(const std::string& text, const std::string& source);
+    void PushKey(SDL_Scancode scancode, bool pressed);
+    static bool IsDue(const Step& step, uint64_t frame);
+};
@@ -1,28 +1,88 @@
 #pragma once
 
 #include <SDL2/SDL.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <map>
 #include <string>
-#include <functional>
 
+// Everything a key can be bound to. Host actions are handled by Emulator on
+// the event thread; guest actions go to the simulation as InputEvents. The
+// values are dense so lookups and the guest button mask are plain indexing.
+enum class Action : uint8_t {
+    None,
+    
+    // Host
+    Quit,
+    ToggleDebug,
+    ToggleAbout,
+    ToggleMenu,
+    DumpTelemetry,
+    ToggleTestPattern,
+    ToggleFullscreen,
+    DumpProfile,
+    
+    // Guest (one button bit each)
+    GuestUp,
+    GuestDown,
+    GuestLeft,
+    GuestRight,
+    GuestSelect,
+    GuestBack,
+    GuestHome,
+    GuestMenu,
+    
+    Count
+};
+
+// A guest key press or release, stamped when it was pumped from SDL
+struct InputEvent {
+    std::chrono::steady_clock::time_point timestamp;
+    Action action;
+    bool pressed;
+};
+
+// Scancode to action bindings.
+// Action names from the config are compiled to Action IDs once, when the
+// mapping is loaded; the per-event lookup is a flat table indexed by scancode.
 class KeyMapper {
 public:
+    static constexpr size_t kScancodeCount = SDL_NUM_SCANCODES;
+    
     KeyMapper();
     ~KeyMapper();
     
     // Map a key to an action
-    void MapKey(SDL_Scancode scancode, const std::string& action);
+    void MapKey(SDL_Scancode scancode, Action action);
+    // By action name; returns false for unknown names
+    bool MapKey(SDL_Scancode scancode, const std::string& actionName);
     
     // Get action for a key
-    std::string GetAction(SDL_Scancode scancode) const;
+    Action GetAction(SDL_Scancode scancode) const {
+        size_t index = static_cast<size_t>(scancode);
+        return index < kScancodeCount ? m_table[index] : Action::None;
+    }
     
     // Check if key is mapped
-    bool IsKeyMapped(SDL_Scancode scancode) const;
+    bool IsKeyMapped(SDL_Scancode scancode) const { return GetAction(scancode) != Action::None; }
     
     // Get key name
     static std::string GetKeyName(SDL_Scancode scancode);
     
-    // Load/Save mappings
+    // Action names as used in config files ("toggle_debug", "guest_back", ...)
+    static const char* GetActionName(Action action);
+    static Action FindAction(const std::string& name);
+    
+    static bool IsGuestAction(Action action) {
+        return action >= Action::GuestUp && action < Action::Count;
+    }
+    // Bit for 'action' in the guest button mask, 0 for host actions
+    static uint32_t GetGuestButton(Action action) {
+        return IsGuestAction(action) ? 1u << (static_cast<int>(action) - static_cast<int>(Action::GuestUp)) : 0u;
+    }
+    
+    // Load/Save mappings (key name -> action name)
     void LoadMappings(const std::map<std::string, std::string>& mappings);
     std::map<std::string, std::string> GetMappings() const;
     
@@ -30,5 +90,5 @@ public:
     void SetDefaultMappings();
     
 private:
-    std::map<SDL_Scancode, std::string> m_keyMappings;
+    std::array<Action, kScancodeCount> m_table;
 };
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Pixel layouts a guest framebuffer can be produced in. RGB565 is a
+// little-endian 16-bit word; the 32-bit formats are named by byte order.
+enum class GuestPixelFormat {
+    RGB565,
+    BGRA8888,
+    RGBA8888
+};
+
+// Instruction set used by the row converters
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON
+};
+
+// Row converters from guest pixel formats to RGBA (bytes R, G, B, A, i.e.
+// SDL_PIXELFORMAT_RGBA32) and a nearest-neighbour integer row scaler.
+// The best implementation the CPU supports is picked on first use: SSE2 on
+// every x86-64 CPU, AVX2 when the CPU and OS support it, NEON on ARM.
+// ForceSimdLevel() lets the benchmark compare them against the scalar code.
+class PixelConvert {
+public:
+    static int GetBytesPerPixel(GuestPixelFormat format);
+    static const char* GetFormatName(GuestPixelFormat format);
+
+    // Convert 'pixels' pixels from 'src' into 'dst'. Neither needs to be aligned.
+    static void ConvertRow(GuestPixelFormat format, const void* src, uint32_t* dst, size_t pixels);
+    // Repeat each of the 'pixels' pixels of 'src' 'factor' times into 'dst'
+    static void ScaleRow(const uint32_t* src, uint32_t* dst, size_t pixels, int factor);
+
+    static SimdLevel GetSimdLevel();
+    // Best level the running CPU supports
+    static SimdLevel GetSupportedSimdLevel();
+    // Use 'level' if supported, otherwise the best supported level below it
+    static void ForceSimdLevel(SimdLevel level);
+    static const char* GetSimdLevelName(SimdLevel level);
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Scoped-zone profiler. PROFILE_ZONE("name") records the enclosing scope;
+// Profiler::WriteTrace dumps what was recorded as Chrome trace-event JSON
+// (open it in ui.perfetto.dev or chrome://tracing).
+//
+// Each thread records into its own fixed-size ring buffer, so recording a
+// zone takes no lock and never allocates after the thread's first zone. The
+// rings keep the newest zones; older ones are overwritten.
+//
+// Built only with EMULATOR_PROFILER defined (the CMake option of the same
+// name); without it PROFILE_ZONE compiles to nothing and WriteTrace fails.
+// Zone names must be string literals (or otherwise live forever).
+class Profiler {
+public:
+    static bool IsEnabled();
+
+    // Nanoseconds on the steady clock since the profiler's first use
+    static uint64_t Now();
+
+    static void Record(const char* name, uint64_t beginNanos, uint64_t endNanos);
+    // Name the calling thread in the trace
+    static void SetThreadName(const char* name);
+
+    // Safe while other threads keep recording
+    static bool WriteTrace(const std::string& filepath);
+};
+
+#ifdef EMULATOR_PROFILER
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : m_name(name)
+        , m_begin(Profiler::Now())
+    {
+    }
+    ~ProfileZone() { Profiler::Record(m_name, m_begin, Profiler::Now()); }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_begin;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+#else
+
+#define PROFILE_ZONE(name) ((void)0)
+
+#endif
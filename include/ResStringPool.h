@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Read-only view over an Android ResStringPool chunk, as found in binary XML
+// (AndroidManifest.xml) and resources.arsc. Nothing is copied on Init; strings
+// are located through the offset table on demand.
+class ResStringPool {
+public:
+    ResStringPool();
+
+    // 'chunk' points at the ResChunk_header of a RES_STRING_POOL_TYPE chunk
+    bool Init(const uint8_t* chunk, size_t size);
+
+    uint32_t GetCount() const { return m_count; }
+    bool IsUTF8() const { return m_utf8; }
+
+    // Compare against an ASCII literal without decoding or allocating
+    bool Equals(uint32_t index, std::string_view ascii) const;
+
+    // Zero-copy view, only available for UTF-8 pools
+    bool GetView(uint32_t index, std::string_view& out) const;
+
+    // Decoded UTF-8 copy (UTF-16 pools are transcoded)
+    std::string Get(uint32_t index) const;
+
+private:
+    const uint8_t* m_offsets;
+    const uint8_t* m_strings;
+    size_t m_stringsSize;
+    uint32_t m_count;
+    bool m_utf8;
+
+    // Start of the string data and its length in code units (bytes or UTF-16 units)
+    bool Locate(uint32_t index, const uint8_t*& data, size_t& units) const;
+};
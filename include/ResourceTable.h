@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Lookup of individual string resources in a resources.arsc table.
+// No index is built: the chunk tree is walked straight to the requested
+// package/type, which is cheaper than indexing when only one or two IDs
+// (app label, version name) are needed per APK.
+class ResourceTable {
+public:
+    // Resolves a resource ID to its string value, preferring the default
+    // (locale-less) configuration. Follows at most a few reference hops.
+    static bool ResolveString(const uint8_t* data, size_t size, uint32_t resId, std::string& out);
+};
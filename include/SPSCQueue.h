@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Lock-free bounded single-producer / single-consumer queue.
+// Head and tail are free-running counters on separate cache lines, and each
+// side keeps a cached copy of the other's counter, so a push or pop only
+// touches the shared line when the cached value says the queue looks full
+// (or empty). A full queue rejects the push instead of blocking the producer.
+template <typename T, size_t Capacity>
+class SPSCQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SPSCQueue()
+        : m_head(0)
+        , m_cachedTail(0)
+        , m_tail(0)
+        , m_cachedHead(0)
+    {
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // Producer side. Returns false if the queue is full.
+    bool TryPush(const T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == Capacity) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == Capacity) {
+                return false;
+            }
+        }
+        m_slots[tail & kMask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool TryPop(T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return false;
+            }
+        }
+        value = m_slots[head & kMask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Either side; exact only when the other side is idle
+    size_t GetSize() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+
+    // Consumer's line: its index and its view of the producer's
+    alignas(64) std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+
+    // Producer's line
+    alignas(64) std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+
+    alignas(64) T m_slots[Capacity];
+};
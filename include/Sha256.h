@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Incremental SHA-256, used to content-address installed APKs
+class Sha256 {
+public:
+    Sha256();
+
+    void Update(const uint8_t* data, size_t size);
+    void Final(uint8_t digest[32]);
+
+    // Lowercase hex of the final digest
+    std::string FinalHex();
+
+private:
+    uint32_t m_state[8];
+    uint64_t m_length;
+    uint8_t m_buffer[64];
+    size_t m_bufferSize;
+
+    void Transform(const uint8_t* block);
+};
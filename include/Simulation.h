@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "ConfigWatcher.h"
+#include "FrameTelemetry.h"
+#include "KeyMapper.h"
+#include "SPSCQueue.h"
+#include "TripleBuffer.h"
+
+// Emulation state advanced by one fixed tick. Everything the renderer needs
+// from the emulation core goes in here.
+struct SimulationState {
+    uint64_t tick = 0;
+    double time = 0.0;          // Simulated seconds since start
+    uint32_t buttons = 0;       // Held guest buttons (KeyMapper::GetGuestButton bits)
+    uint64_t inputEvents = 0;   // Guest input events applied so far
+};
+
+// Time from an input event being pumped from SDL to the guest state seeing it
+struct InputLatencyStats {
+    uint64_t events = 0;
+    uint32_t p50Micros = 0;
+    uint32_t p99Micros = 0;
+    uint32_t maxMicros = 0;
+};
+
+// What the simulation hands to the render thread: the last two ticks, so the
+// renderer can interpolate to its own present time
+struct SimulationSnapshot {
+    SimulationState previous;
+    SimulationState current;
+    std::chrono::steady_clock::time_point currentAt;   // Wall time the current tick completed
+    double tickSeconds = 0.0;
+    uint64_t droppedTicks = 0;
+    InputLatencyStats inputLatency;
+};
+
+// Fixed-timestep emulation core on its own thread.
+// Real time is accumulated and consumed in whole ticks, so the simulation
+// advances identically regardless of render speed. A slow render never stalls
+// it, and a slow tick never blocks a frame: the render thread always has the
+// last complete snapshot from the triple buffer.
+// Guest input arrives through a lock-free SPSC queue from the event thread.
+// Pushing an event wakes the simulation thread, which applies it to the guest
+// state immediately rather than at the next tick boundary.
+class Simulation {
+public:
+    explicit Simulation(int tickRate = 60);
+    ~Simulation();
+
+    void Start();
+    void Stop();
+    bool IsRunning() const { return m_thread.joinable(); }
+
+    // Render thread: fetch the newest snapshot (cheap, never blocks)
+    const SimulationSnapshot& AcquireSnapshot();
+
+    // Blend factor in [0, 1] between snapshot.previous and snapshot.current at 'now'
+    static double GetInterpolationAlpha(const SimulationSnapshot& snapshot,
+                                        std::chrono::steady_clock::time_point now);
+    static SimulationState Interpolate(const SimulationSnapshot& snapshot, double alpha);
+
+    double GetTickSeconds() const { return m_tickSeconds; }
+
+    // Follow "tick_rate" edits while running; call before Start
+    void SetConfigSource(ConfigWatcher* watcher);
+
+    // Event thread: queue a guest input event and wake the simulation.
+    // Returns false (and counts a drop) if the queue is full.
+    bool PushInput(const InputEvent& event);
+    uint64_t GetDroppedInputs() const { return m_droppedInputs; }
+
+    // Deterministic runs: step 'ticks' ticks on the calling thread and publish
+    // them. Does nothing while the simulation thread is running.
+    void Advance(int ticks);
+
+private:
+    // Catch-up is capped so one long stall can't snowball into ever longer frames
+    static constexpr int kMaxTicksPerUpdate = 5;
+    static constexpr size_t kInputQueueSize = 256;
+
+    double m_tickSeconds;
+    std::atomic<bool> m_stopping;
+    std::thread m_thread;
+    TripleBuffer<SimulationSnapshot> m_snapshots;
+
+    // Input: the queue, plus a wake-up so the thread need not wait for the next tick
+    SPSCQueue<InputEvent, kInputQueueSize> m_input;
+    std::atomic<bool> m_inputPending;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    uint64_t m_droppedInputs;       // Owned by the event thread
+
+    // Owned by the simulation thread
+    SimulationState m_state;
+    SimulationState m_previousState;
+    uint64_t m_droppedTicks;
+    std::chrono::steady_clock::time_point m_lastTickAt;
+    LatencyHistogram m_inputLatency;
+    InputLatencyStats m_inputLatencyStats;
+
+    // Reloaded settings, checked once per loop
+    ConfigWatcher* m_configWatcher;
+    int m_configReader;
+    uint64_t m_configGeneration;
+
+    void ThreadLoop();
+    // Pick up a changed tick rate; returns true if it changed
+    bool ApplyConfig();
+    void Step(double dt);
+    // Apply queued input to the state; returns true if there was any
+    bool DrainInput();
+    void PublishSnapshot(std::chrono::steady_clock::time_point tickAt);
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Startup phase trace, written as Chrome trace-event JSON (load it in
+// chrome://tracing or ui.perfetto.dev). Times are microseconds since the
+// process started, so time to first frame includes everything before main().
+// Recording takes a mutex; it is meant for the few dozen startup phases,
+// from any thread, not for per-frame use.
+class StartupTrace {
+public:
+    // Microseconds since process start
+    static uint64_t Now();
+
+    static void AddPhase(const char* name, uint64_t beginMicros, uint64_t endMicros);
+    // A point in time, e.g. the first frame reaching the screen
+    static void AddMark(const char* name);
+    // Name the calling thread in the trace
+    static void SetThreadName(const char* name);
+
+    static bool Write(const std::string& filepath);
+};
+
+// Records the enclosing scope as one startup phase
+class StartupPhase {
+public:
+    explicit StartupPhase(const char* name)
+        : m_name(name)
+        , m_begin(StartupTrace::Now())
+    {
+    }
+    ~StartupPhase() { StartupTrace::AddPhase(m_name, m_begin, StartupTrace::Now()); }
+
+    StartupPhase(const StartupPhase&) = delete;
+    StartupPhase& operator=(const StartupPhase&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_begin;
+};
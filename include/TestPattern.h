@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "GuestFramebuffer.h"
+
+// Synthetic guest output for exercising the framebuffer path without a guest.
+// Colour bars, a gradient that scrolls with the simulation tick, a bouncing
+// checkerboard square and a one-pixel border, so tearing, scaling and
+// colour-conversion errors are easy to see. The buffer is allocated once.
+class TestPattern {
+public:
+    TestPattern(int width, int height, GuestPixelFormat format);
+
+    // Draw the frame for 'tick'; the result is valid until the next call
+    const GuestFrame& Render(uint64_t tick);
+
+    int GetWidth() const { return m_frame.width; }
+    int GetHeight() const { return m_frame.height; }
+    GuestPixelFormat GetFormat() const { return m_frame.format; }
+
+private:
+    std::vector<uint8_t> m_pixels;
+    GuestFrame m_frame;
+
+    void FillSpan(uint8_t* row, int x0, int x1, uint8_t r, uint8_t g, uint8_t b) const;
+    void PutPixel(uint8_t* row, int x, uint8_t r, uint8_t g, uint8_t b) const;
+};
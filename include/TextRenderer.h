@@ -0,0 +1,94 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Bitmap-font text renderer.
+// The embedded font is rasterized once into a small atlas texture that also has
+// a solid white cell, so text and filled shapes sample the same texture and can
+// share one vertex batch (see DrawList). Each string's layout (glyph indices and
+// offsets) is cached by content, so unchanged text is not laid out again.
+class TextRenderer {
+public:
+    // 'scale' is the integer pixel size of one font texel
+    explicit TextRenderer(SDL_Renderer* renderer, int scale = 2);
+    ~TextRenderer();
+
+    TextRenderer(const TextRenderer&) = delete;
+    TextRenderer& operator=(const TextRenderer&) = delete;
+
+    // Append one quad (four vertices: top-left, top-right, bottom-left,
+    // bottom-right) per visible glyph of 'text', top-left corner at (x, y).
+    // '\n' starts a new line.
+    void AppendText(std::string_view text, int x, int y, SDL_Color color, std::vector<SDL_Vertex>& out);
+    // Append a quad that samples the atlas's solid cell
+    void AppendSolid(const SDL_FRect& rect, SDL_Color color, std::vector<SDL_Vertex>& out) const;
+    // Size of 'text' in pixels, as AppendText would lay it out
+    SDL_Point MeasureText(std::string_view text);
+
+    // Nullptr if the atlas could not be created
+    SDL_Texture* GetAtlas() const { return m_atlas; }
+    // Build the atlas texture again, e.g. after the renderer lost its textures
+    void RecreateAtlas();
+    SDL_Point GetAtlasSize() const { return {m_atlasWidth, m_atlasHeight}; }
+
+    // Change the texel size; cached layouts are dropped
+    void SetScale(int scale);
+    int GetScale() const { return m_scale; }
+    int GetLineHeight() const { return (kCellHeight + 1) * m_scale; }
+    int GetCharWidth() const { return kCellWidth * m_scale; }
+
+    // Statistics
+    uint64_t GetCacheHits() const { return m_cacheHits; }
+    uint64_t GetCacheMisses() const { return m_cacheMisses; }
+
+private:
+    // Atlas cells are one texel wider and taller than the glyphs, so sampling
+    // never bleeds into a neighbour. The cell after the last glyph is solid.
+    static constexpr int kCellWidth = 6;
+    static constexpr int kCellHeight = 8;
+    static constexpr int kAtlasColumns = 16;
+
+    // Layouts of strings up to kMaxCachedLength characters are cached in a
+    // direct-mapped table; longer strings are laid out on every draw
+    static constexpr size_t kCacheSlots = 128;
+    static constexpr size_t kMaxCachedLength = 64;
+
+    struct GlyphQuad {
+        int16_t x;
+        int16_t y;
+        uint8_t glyph;
+    };
+
+    struct Layout {
+        uint64_t hash;
+        uint16_t length;      // 0 = empty slot
+        uint16_t quadCount;
+        SDL_Point size;
+        char text[kMaxCachedLength];
+        GlyphQuad quads[kMaxCachedLength];
+    };
+
+    SDL_Renderer* m_renderer;
+    SDL_Texture* m_atlas;
+    int m_atlasWidth;
+    int m_atlasHeight;
+    int m_scale;
+
+    std::unique_ptr<Layout[]> m_cache;
+
+    uint64_t m_cacheHits;
+    uint64_t m_cacheMisses;
+
+    bool CreateAtlas();
+    const Layout& GetLayout(std::string_view text);
+    void BuildLayout(std::string_view text, Layout& layout) const;
+    // Calls visit(x, y, glyph) for each visible glyph of 'text'; returns its size
+    template <typename Visit>
+    SDL_Point LayOut(std::string_view text, Visit&& visit) const;
+    void AppendGlyph(float x, float y, int glyph, SDL_Color color, std::vector<SDL_Vertex>& out) const;
+};
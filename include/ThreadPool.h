@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size work-stealing thread pool.
+// Each worker owns a deque: it pops its own work LIFO (cache-warm) and, when empty,
+// steals FIFO from the other workers, so uneven task costs (e.g. one huge APK among
+// many small ones) don't leave cores idle.
+class ThreadPool {
+public:
+    // threadCount == 0 uses one thread per hardware core
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> task);
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    std::atomic<size_t> m_queued;
+    std::atomic<size_t> m_nextQueue;
+    bool m_stopping;
+
+    void WorkerLoop(size_t index);
+    // 'waitForSteal': block on sibling queues instead of skipping busy ones
+    bool PopTask(size_t index, std::function<void()>& task, bool waitForSteal);
+};
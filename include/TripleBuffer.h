@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer / single-consumer triple buffer.
+// The writer fills the back slot and publishes it; the reader picks up the
+// newest published slot whenever it likes. Neither side ever waits on the
+// other: a slow reader just skips intermediate values, and a slow writer
+// leaves the reader looking at the last complete value.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer()
+        : m_middle(1)
+        , m_back(0)
+        , m_front(2)
+    {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side
+    T& GetWriteBuffer() { return m_slots[m_back].value; }
+    void Publish() {
+        uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | kFresh), std::memory_order_acq_rel);
+        m_back = previous & kIndexMask;
+    }
+
+    // Reader side. Returns true if a newer value was swapped in.
+    bool Update() {
+        if ((m_middle.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & kIndexMask;
+        return true;
+    }
+    const T& GetReadBuffer() const { return m_slots[m_front].value; }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    // Each slot on its own cache line so the two threads don't false-share
+    struct alignas(64) Slot {
+        T value{};
+    };
+
+    Slot m_slots[3];
+    std::atomic<uint8_t> m_middle;   // Slot index shared by both sides, plus the fresh bit
+    uint8_t m_back;                  // Owned by the writer
+    uint8_t m_front;                 // Owned by the reader
+};
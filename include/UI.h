@@ -1,9 +1,22 @@
 #pragma once
 
+#include "DrawList.h"
+#include "TextRenderer.h"
+#include "UILayout.h"
+#include "VirtualList.h"
 #include <SDL2/SDL.h>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+// Retained-mode UI. Each widget keeps a DrawList that is rebuilt only when the
+// widget's content changes; the Render* calls just mark a widget visible for
+// this frame. The static widgets (menu, APK list, about screen) are composited
+// into a cached render-target texture that is redrawn only when one of them
+// changes or appears/disappears, so an idle frame costs a single texture copy
+// plus the per-frame overlays.
 class UI {
 public:
     UI(SDL_Renderer* renderer);
@@ -11,13 +24,38 @@ public:
     
     // Rendering
     void RenderFPS(float fps, float frameTime);
-    void RenderDebugOverlay(const std::vector<std::string>& debugInfo);
+    void RenderDebugOverlay(const std::string_view* lines, size_t lineCount);
     void RenderAboutScreen();
     void RenderMainMenu();
-    void RenderAPKList(const std::vector<std::string>& apkList);
+    // 'generation' changes whenever the list contents do (APKCatalog::GetGeneration).
+    // Only the visible rows are built; see VirtualList.
+    void RenderAPKList(const std::vector<std::string_view>& apkList, uint64_t generation);
+    
+    // Per-frame animation (kinetic scrolling)
+    void Update(float deltaTime);
+    
+    // Renderer output size in pixels. Relayouts (and rebuilds every widget) only
+    // if it changed; returns true in that case.
+    bool SetOutputSize(int width, int height);
+    const UILayout& GetLayout() const { return m_layout; }
+    
+    // Draw this frame's widgets; call after the last Render*
+    void EndFrame();
+    // Textures were lost (render targets or device reset): rebuild the font
+    // atlas and redraw the cached layer
+    void InvalidateCache();
+    
+    // Statistics
+    int GetLastDrawCalls() const { return m_lastDrawCalls; }
+    uint64_t GetRebuildCount() const { return m_rebuilds; }
+    uint64_t GetLayerRedrawCount() const { return m_layerRedraws; }
     
     // Input
     bool HandleClick(int x, int y);
+    // APK list filter and scrolling; return true if the input was used
+    bool HandleKey(SDL_Scancode scancode);
+    void HandleTextInput(const char* text);
+    void HandleScroll(float wheelY);
     
     // State
     void SetShowDebug(bool show) { m_showDebug = show; }
@@ -25,15 +63,51 @@ public:
     void SetShowMenu(bool show) { m_showMenu = show; }
     
 private:
+    // Widgets of the cached layer, in drawing order
+    enum Layer : uint32_t {
+        kLayerMenu = 1u << 0,
+        kLayerAPKList = 1u << 1,
+        kLayerAbout = 1u << 2
+    };
+    static constexpr uint64_t kNotBuilt = ~0ull;
+    
     SDL_Renderer* m_renderer;
     bool m_showDebug;
     bool m_showAbout;
     bool m_showMenu;
+    std::unique_ptr<TextRenderer> m_text;
+    UILayout m_layout;
+    
+    // Each widget's draw list and the key (content hash or layout generation) it was built from
+    std::unique_ptr<DrawList> m_menuList;
+    std::unique_ptr<DrawList> m_apkList;
+    std::unique_ptr<DrawList> m_aboutList;
+    std::unique_ptr<DrawList> m_debugList;
+    std::unique_ptr<DrawList> m_fpsList;
+    std::unique_ptr<VirtualList> m_apkView;
+    uint64_t m_menuKey;
+    uint64_t m_aboutKey;
+    uint64_t m_debugKey;
+    uint64_t m_fpsKey;
+    
+    // Cached layer
+    SDL_Texture* m_layer;
+    int m_layerWidth;
+    int m_layerHeight;
+    uint32_t m_frameLayers;     // Static widgets shown this frame
+    uint32_t m_cachedLayers;    // Static widgets in m_layer
+    bool m_layerDirty;
+    bool m_frameDebug;
+    bool m_frameFPS;
+    
+    int m_lastDrawCalls;
+    uint64_t m_rebuilds;
+    uint64_t m_layerRedraws;
     
-    // Simple text rendering (SDL2 doesn't have built-in TTF, but we'll use basic rendering)
-    void DrawText(const std::string& text, int x, int y, SDL_Color color);
-    void DrawRect(int x, int y, int w, int h, SDL_Color color, bool filled = true);
-    void DrawLine(int x1, int y1, int x2, int y2, SDL_Color color);
+    void BuildMainMenu(DrawList& list);
+    void BuildAboutScreen(DrawList& list);
+    bool EnsureLayer();
+    int DrawLayerWidgets();
     
     // UI Colors
     SDL_Color m_textColor;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class LayoutRegion {
+    Content,        // Guest display area
+    Menu,
+    APKList,
+    About,
+    DebugOverlay,   // Top-left corner; the overlay sizes itself to its text
+    FPSCounter,
+    Count
+};
+
+// Resolution-independent placement of the UI and the content area.
+// Everything is specified in design units (dp) against a 1280x720 reference
+// and scaled by how well that reference fits the renderer output, so 4K gets
+// 3x sized UI and ultrawide displays keep the 16:9 proportions for the UI
+// while the content area fills the width. The solved rectangles are cached;
+// Update() only solves again when the output size changes (window resize,
+// moving to a display with a different pixel density).
+class UILayout {
+public:
+    static constexpr int kDesignWidth = 1280;
+    static constexpr int kDesignHeight = 720;
+
+    UILayout();
+
+    // Returns true if the layout changed
+    bool Update(int outputWidth, int outputHeight);
+
+    const SDL_Rect& GetRect(LayoutRegion region) const { return m_rects[static_cast<size_t>(region)]; }
+    // Pixels per design unit
+    float GetScale() const { return m_scale; }
+    // Design units to pixels
+    int Scale(int dp) const;
+    // Integer pixel size of one font texel
+    int GetTextScale() const { return m_textScale; }
+
+    int GetOutputWidth() const { return m_outputWidth; }
+    int GetOutputHeight() const { return m_outputHeight; }
+    // Number of layout passes so far; widgets compare it to know when to rebuild
+    uint64_t GetGeneration() const { return m_generation; }
+
+private:
+    int m_outputWidth;
+    int m_outputHeight;
+    float m_scale;
+    int m_textScale;
+    uint64_t m_generation;
+    std::array<SDL_Rect, static_cast<size_t>(LayoutRegion::Count)> m_rects;
+
+    void Solve();
+};
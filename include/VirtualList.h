@@ -0,0 +1,106 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class DrawList;
+class TextRenderer;
+
+// Scroll-windowed list over a vector of labels (e.g. APKCatalog::GetNames()).
+// Only the rows inside the viewport are recorded, from a fixed pool of row
+// slots that keep their item binding while it stays visible, so the cost of a
+// rebuild depends on the viewport height, not on the number of items.
+// Scrolling is kinetic (wheel and keys add velocity that decays with friction)
+// and filtering is incremental: a case-insensitive substring filter examines at
+// most kFilterBudget items per frame, and typing more characters only narrows
+// the previous matches instead of rescanning everything.
+class VirtualList {
+public:
+    static constexpr size_t kFilterBudget = 8192;
+
+    explicit VirtualList(TextRenderer& text);
+    ~VirtualList();
+
+    void SetBounds(const SDL_Rect& bounds);
+    // Row and header heights in pixels; padding and scrollbar follow the row height
+    void SetMetrics(int rowHeight, int headerHeight);
+    const SDL_Rect& GetBounds() const { return m_bounds; }
+
+    // 'items' must stay valid while 'generation' is unchanged; a new generation
+    // restarts the filter. Also advances an unfinished filter pass.
+    void SetItems(const std::vector<std::string_view>* items, uint64_t generation);
+
+    // Filter-as-you-type
+    void AppendFilter(std::string_view text);
+    void EraseFilterChar();
+    void SetFilter(std::string_view filter);
+    const std::string& GetFilter() const { return m_filter; }
+    bool IsFiltering() const { return m_filterPending; }
+
+    // Kinetic scrolling: 'rows' (wheel notches, arrow keys) becomes velocity
+    void ScrollRows(float rows);
+    void ScrollPages(float pages);
+    // Advance the scroll animation
+    void Update(float deltaTime);
+
+    // True when the visible content changed since the last Build()
+    bool IsDirty() const;
+    // Record the header, the visible rows and the scrollbar into 'list'
+    void Build(DrawList& list);
+
+    size_t GetItemCount() const { return m_items ? m_items->size() : 0; }
+    size_t GetMatchCount() const;
+    size_t GetFirstVisibleRow() const;
+    size_t GetVisibleRowCount() const { return m_rows.size(); }
+
+private:
+    // Recycled row state: which item a slot shows, and its label cut to fit
+    struct Row {
+        size_t item;
+        std::string_view label;
+    };
+    static constexpr size_t kNoItem = ~size_t(0);
+
+    TextRenderer& m_text;
+    SDL_Rect m_bounds;
+    int m_rowHeight;
+    int m_headerHeight;
+    int m_padding;
+    int m_scrollbarWidth;
+
+    const std::vector<std::string_view>* m_items;
+    uint64_t m_generation;
+
+    // Filter state. With an empty filter every item matches and m_matches is unused.
+    std::string m_filter;
+    std::string m_lowerFilter;
+    std::vector<uint32_t> m_matches;      // Item indices, in item order
+    std::vector<uint32_t> m_candidates;   // Previous matches being narrowed
+    bool m_narrowing;                     // Scanning m_candidates instead of all items
+    size_t m_scanPosition;
+    bool m_filterPending;
+
+    // Scroll state, in pixels
+    float m_scroll;
+    float m_velocity;
+
+    std::vector<Row> m_rows;
+
+    // What the last Build() showed
+    bool m_dirty;
+    int m_builtScroll;
+    size_t m_builtMatches;
+
+    void RestartFilter(bool narrow);
+    void StepFilter();
+    bool Matches(std::string_view label) const;
+    void ResetScroll();
+    size_t GetItemAt(size_t row) const;
+    float GetMaxScroll() const;
+    void ResetRows();
+    int GetListHeight() const { return m_bounds.h - m_headerHeight; }
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ByteReader.h"
+#include "MappedFile.h"
+
+struct ZipEntry {
+    std::string_view name;      // Points into the mapped central directory
+    uint16_t method;            // 0 = stored, 8 = deflate
+    uint16_t flags;
+    uint32_t crc32;
+    uint64_t compressedSize;
+    uint64_t uncompressedSize;
+    uint64_t localHeaderOffset;
+};
+
+// Read-only ZIP (and therefore APK) reader over a memory-mapped file.
+// Opening only parses the end-of-central-directory record and the central directory,
+// so the cost is proportional to the number of entries, not to the archive size.
+// Entry data is only touched when an entry is actually read.
+class ZipArchive {
+public:
+    ZipArchive();
+    ~ZipArchive();
+
+    bool Open(const std::string& filepath);
+    void Close();
+    bool IsOpen() const { return m_file.IsOpen(); }
+
+    size_t GetEntryCount() const { return m_entries.size(); }
+    const std::vector<ZipEntry>& GetEntries() const { return m_entries; }
+    const ZipEntry* FindEntry(std::string_view name) const;
+
+    // Raw (possibly compressed) bytes of an entry inside the mapping
+    ByteView GetRawData(const ZipEntry& entry) const;
+
+    // Stored entries are returned as a view into the mapping without copying.
+    // Deflated entries are inflated into 'scratch' and 'out' points at it; an
+    // entry claiming more than 256 MB, or more than DEFLATE's 1032:1 maximum
+    // expansion of its compressed size, is rejected before allocating.
+    bool ReadEntry(const ZipEntry& entry, std::vector<uint8_t>& scratch, ByteView& out) const;
+
+    uint64_t GetFileSize() const { return m_file.GetSize(); }
+
+private:
+    MappedFile m_file;
+    std::vector<ZipEntry> m_entries;
+    std::unordered_map<std::string_view, size_t> m_index;
+
+    bool ReadCentralDirectory();
+};
@@ -0,0 +1,222 @@
+#include "APKCatalog.h"
+#include <cstring>
+
+namespace {
+
+constexpr size_t kBlockSize = 16 * 1024;
+constexpr size_t kMinSlots = 16;
+
+// FNV-1a; package names are short, so this beats std::hash's setup cost
+uint64_t HashPackage(std::string_view s) {
+    uint64_t h = 14695981039346656037ull;
+    for (char c : s) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+} // namespace
+
+APKCatalog::APKCatalog()
+    : m_block(nullptr)
+    , m_blockUsed(kBlockSize)
+    , m_generation(0)
+{
+}
+
+APKCatalog::~APKCatalog() {
+}
+
+size_t APKCatalog::Add(const APKInfo& info) {
+    size_t index = m_names.size();
+    m_names.push_back(Intern(info.name));
+    m_packageNames.push_back(Intern(info.packageName));
+    m_filepaths.push_back(Intern(info.filepath));
+    m_versions.push_back(Intern(info.version));
+    m_contentHashes.push_back(Intern(info.contentHash));
+    m_versionCodes.push_back(info.versionCode);
+    m_minSdkVersions.push_back(info.minSdkVersion);
+    m_targetSdkVersions.push_back(info.targetSdkVersion);
+    m_packageHashes.push_back(HashPackage(info.packageName));
+
+    // Keep the table at most half full so probe chains stay short
+    if ((index + 1) * 2 > m_slots.size()) {
+        RebuildIndex();
+    }
+    else {
+        InsertSlot(index);
+    }
+    ++m_generation;
+    return index;
+}
+
+void APKCatalog::Remove(size_t index) {
+    if (index >= m_names.size()) {
+        return;
+    }
+
+    size_t last = m_names.size() - 1;
+    if (index != last) {
+        m_names[index] = m_names[last];
+        m_packageNames[index] = m_packageNames[last];
+        m_filepaths[index] = m_filepaths[last];
+        m_versions[index] = m_versions[last];
+        m_contentHashes[index] = m_contentHashes[last];
+        m_versionCodes[index] = m_versionCodes[last];
+        m_minSdkVersions[index] = m_minSdkVersions[last];
+        m_targetSdkVersions[index] = m_targetSdkVersions[last];
+        m_packageHashes[index] = m_packageHashes[last];
+    }
+    m_names.pop_back();
+    m_packageNames.pop_back();
+    m_filepaths.pop_back();
+    m_versions.pop_back();
+    m_contentHashes.pop_back();
+    m_versionCodes.pop_back();
+    m_minSdkVersions.pop_back();
+    m_targetSdkVersions.pop_back();
+    m_packageHashes.pop_back();
+
+    // Open addressing can't simply drop a slot; removals are rare, so re-index
+    RebuildIndex();
+    ++m_generation;
+}
+
+void APKCatalog::Clear() {
+    m_names.clear();
+    m_packageNames.clear();
+    m_filepaths.clear();
+    m_versions.clear();
+    m_contentHashes.clear();
+    m_versionCodes.clear();
+    m_minSdkVersions.clear();
+    m_targetSdkVersions.clear();
+    m_packageHashes.clear();
+    m_slots.clear();
+
+    m_interned.clear();
+    m_blocks.clear();
+    m_block = nullptr;
+    m_blockUsed = kBlockSize;
+    ++m_generation;
+}
+
+void APKCatalog::Reserve(size_t count) {
+    m_names.reserve(count);
+    m_packageNames.reserve(count);
+    m_filepaths.reserve(count);
+    m_versions.reserve(count);
+    m_contentHashes.reserve(count);
+    m_versionCodes.reserve(count);
+    m_minSdkVersions.reserve(count);
+    m_targetSdkVersions.reserve(count);
+    m_packageHashes.reserve(count);
+}
+
+size_t APKCatalog::FindPackage(std::string_view packageName) const {
+    if (m_slots.empty()) {
+        return kNotFound;
+    }
+
+    uint64_t hash = HashPackage(packageName);
+    size_t mask = m_slots.size() - 1;
+    for (size_t slot = static_cast<size_t>(hash) & mask;; slot = (slot + 1) & mask) {
+        uint32_t entry = m_slots[slot];
+        if (entry == 0) {
+            return kNotFound;
+        }
+        size_t index = entry - 1;
+        if (m_packageHashes[index] == hash && m_packageNames[index] == packageName) {
+            return index;
+        }
+    }
+}
+
+size_t APKCatalog::FindContentHash(std::string_view contentHash) const {
+    // Only used when installs land, so a scan of one column is plenty
+    for (size_t i = 0; i < m_contentHashes.size(); ++i) {
+        if (m_contentHashes[i] == contentHash) {
+            return i;
+        }
+    }
+    return kNotFound;
+}
+
+APKView APKCatalog::GetView(size_t index) const {
+    APKView view;
+    view.name = m_names[index];
+    view.packageName = m_packageNames[index];
+    view.filepath = m_filepaths[index];
+    view.version = m_versions[index];
+    view.contentHash = m_contentHashes[index];
+    view.versionCode = m_versionCodes[index];
+    view.minSdkVersion = m_minSdkVersions[index];
+    view.targetSdkVersion = m_targetSdkVersions[index];
+    return view;
+}
+
+APKInfo APKCatalog::GetInfo(size_t index) const {
+    APKInfo info;
+    info.name = std::string(m_names[index]);
+    info.packageName = std::string(m_packageNames[index]);
+    info.filepath = std::string(m_filepaths[index]);
+    info.version = std::string(m_versions[index]);
+    info.contentHash = std::string(m_contentHashes[index]);
+    info.versionCode = m_versionCodes[index];
+    info.minSdkVersion = m_minSdkVersions[index];
+    info.targetSdkVersion = m_targetSdkVersions[index];
+    return info;
+}
+
+std::string_view APKCatalog::Intern(std::string_view s) {
+    if (s.empty()) {
+        return std::string_view();
+    }
+
+    auto it = m_interned.find(s);
+    if (it != m_interned.end()) {
+        return *it;
+    }
+
+    char* dest;
+    if (s.size() > kBlockSize / 4) {
+        // Oversized strings get a block of their own; the current block stays open
+        m_blocks.push_back(std::make_unique<char[]>(s.size()));
+        dest = m_blocks.back().get();
+    }
+    else {
+        if (kBlockSize - m_blockUsed < s.size()) {
+            m_blocks.push_back(std::make_unique<char[]>(kBlockSize));
+            m_block = m_blocks.back().get();
+            m_blockUsed = 0;
+        }
+        dest = m_block + m_blockUsed;
+        m_blockUsed += s.size();
+    }
+
+    std::memcpy(dest, s.data(), s.size());
+    std::string_view stored(dest, s.size());
+    m_interned.insert(stored);
+    return stored;
+}
+
+void APKCatalog::InsertSlot(size_t index) {
+    size_t mask = m_slots.size() - 1;
+    size_t slot = static_cast<size_t>(m_packageHashes[index]) & mask;
+    while (m_slots[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    m_slots[slot] = static_cast<uint32_t>(index + 1);
+}
+
+void APKCatalog::RebuildIndex() {
+    size_t capacity = kMinSlots;
+    while (capacity < m_names.size() * 2) {
+        capacity *= 2;
+    }
+    m_slots.assign(capacity, 0);
+    for (size_t i = 0; i < m_names.size(); ++i) {
+        InsertSlot(i);
+    }
+}
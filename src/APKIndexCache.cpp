@@ -0,0 +1,160 @@
+#include "APKIndexCache.h"
+#include "AtomicFile.h"
+#include "ByteReader.h"
+#include "MappedFile.h"
+#include <iostream>
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t kIndexMagic = 0x494b5041; // "APKI"
+constexpr uint32_t kIndexVersion = 1;
+constexpr size_t kHeaderSize = 12;
+constexpr size_t kRecordFixedSize = 32;
+
+void WriteLE32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out += static_cast<char>((v >> (i * 8)) & 0xff);
+    }
+}
+
+void WriteLE64(std::string& out, uint64_t v) {
+    WriteLE32(out, static_cast<uint32_t>(v));
+    WriteLE32(out, static_cast<uint32_t>(v >> 32));
+}
+
+void WriteString(std::string& out, const std::string& s) {
+    uint16_t len = static_cast<uint16_t>(s.size() > 0xffff ? 0xffff : s.size());
+    out += static_cast<char>(len & 0xff);
+    out += static_cast<char>(len >> 8);
+    out.append(s, 0, len);
+}
+
+bool ReadString(const uint8_t*& p, const uint8_t* end, std::string& s) {
+    if (end - p < 2) {
+        return false;
+    }
+    uint16_t len = ReadLE16(p);
+    p += 2;
+    if (end - p < len) {
+        return false;
+    }
+    s.assign(reinterpret_cast<const char*>(p), len);
+    p += len;
+    return true;
+}
+
+} // namespace
+
+APKIndexCache::APKIndexCache() {
+}
+
+APKIndexCache::~APKIndexCache() {
+}
+
+bool APKIndexCache::Load(const std::string& filepath) {
+    m_entries.clear();
+
+    std::error_code ec;
+    if (!fs::exists(filepath, ec)) {
+        return false;
+    }
+
+    MappedFile file;
+    if (!file.Open(filepath)) {
+        return false;
+    }
+
+    const uint8_t* p = file.GetData();
+    const uint8_t* end = p + file.GetSize();
+    if (file.GetSize() < kHeaderSize || ReadLE32(p) != kIndexMagic || ReadLE32(p + 4) != kIndexVersion) {
+        return false;
+    }
+    uint32_t count = ReadLE32(p + 8);
+    p += kHeaderSize;
+
+    // A damaged count must not size the reservation: every record takes at
+    // least its fixed part, so more than fit in the file means a bad index
+    if (count > (file.GetSize() - kHeaderSize) / kRecordFixedSize) {
+        return false;
+    }
+    m_entries.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (static_cast<size_t>(end - p) < kRecordFixedSize) {
+            m_entries.clear();
+            return false;
+        }
+
+        Entry entry;
+        entry.size = ReadLE64(p);
+        entry.mtime = static_cast<int64_t>(ReadLE64(p + 8));
+        entry.info.versionCode = static_cast<int64_t>(ReadLE64(p + 16));
+        entry.info.minSdkVersion = static_cast<int32_t>(ReadLE32(p + 24));
+        entry.info.targetSdkVersion = static_cast<int32_t>(ReadLE32(p + 28));
+        p += kRecordFixedSize;
+
+        if (!ReadString(p, end, entry.info.filepath) ||
+            !ReadString(p, end, entry.info.name) ||
+            !ReadString(p, end, entry.info.packageName) ||
+            !ReadString(p, end, entry.info.version)) {
+            // A truncated index is worthless; fall back to a full scan
+            m_entries.clear();
+            return false;
+        }
+
+        std::string key = entry.info.filepath;
+        m_entries.emplace(std::move(key), std::move(entry));
+    }
+    return true;
+}
+
+bool APKIndexCache::Save(const std::string& filepath) const {
+    std::string buffer;
+    buffer.reserve(kHeaderSize + m_entries.size() * (kRecordFixedSize + 96));
+    WriteLE32(buffer, kIndexMagic);
+    WriteLE32(buffer, kIndexVersion);
+    WriteLE32(buffer, static_cast<uint32_t>(m_entries.size()));
+
+    for (const auto& pair : m_entries) {
+        const Entry& entry = pair.second;
+        WriteLE64(buffer, entry.size);
+        WriteLE64(buffer, static_cast<uint64_t>(entry.mtime));
+        WriteLE64(buffer, static_cast<uint64_t>(entry.info.versionCode));
+        WriteLE32(buffer, static_cast<uint32_t>(entry.info.minSdkVersion));
+        WriteLE32(buffer, static_cast<uint32_t>(entry.info.targetSdkVersion));
+        WriteString(buffer, entry.info.filepath);
+        WriteString(buffer, entry.info.name);
+        WriteString(buffer, entry.info.packageName);
+        WriteString(buffer, entry.info.version);
+    }
+
+    // A crash never leaves a torn index
+    if (!WriteFileAtomic(filepath, buffer)) {
+        std::cerr << "Error: Could not write APK index " << filepath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void APKIndexCache::Clear() {
+    m_entries.clear();
+}
+
+bool APKIndexCache::Lookup(const std::string& path, uint64_t size, int64_t mtime, APKInfo& info) const {
+    auto it = m_entries.find(path);
+    if (it == m_entries.end() || it->second.size != size || it->second.mtime != mtime) {
+        return false;
+    }
+    info = it->second.info;
+    return true;
+}
+
+void APKIndexCache::Store(const APKInfo& info, uint64_t size, int64_t mtime) {
+    Entry& entry = m_entries[info.filepath];
+    entry.size = size;
+    entry.mtime = mtime;
+    entry.info = info;
+}
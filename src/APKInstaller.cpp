@@ -0,0 +1,400 @@
+#include "APKInstaller.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include "Sha256.h"
+#include "ZipArchive.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Large enough to amortize syscalls, small enough for smooth progress reporting
+constexpr size_t kChunkSize = 8 * 1024 * 1024;
+
+std::string BlobPath(const std::string& storeDirectory, const std::string& hash) {
+    return (fs::path(storeDirectory) / (hash + ".apk")).string();
+}
+
+void MarkStored(InstallResult& result, const std::string& blobPath, const std::string& contentHash) {
+    result.info.filepath = blobPath;
+    result.info.contentHash = contentHash;
+    result.success = true;
+}
+
+// Hash from the source mapping, reporting progress; 'hash' is null when the
+// content hash is already known and only the progress matters
+void HashMapped(const MappedFile& source, Sha256* hash, std::atomic<uint64_t>& done) {
+    const uint8_t* data = source.GetData();
+    size_t size = source.GetSize();
+    for (size_t offset = 0; offset < size; offset += kChunkSize) {
+        size_t n = std::min(kChunkSize, size - offset);
+        if (hash) {
+            hash->Update(data + offset, n);
+        }
+        done.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+bool TryHardLink(const std::string& source, const std::string& destination) {
+    std::error_code ec;
+    fs::create_hard_link(source, destination, ec);
+    return !ec;
+}
+
+#ifdef _WIN32
+
+bool StreamCopy(const MappedFile& source, const std::string& destination, Sha256* hash,
+                std::atomic<uint64_t>& done, CopyMethod& method, std::string& error) {
+    std::ofstream out(fs::path(destination), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        error = "could not create " + destination;
+        return false;
+    }
+
+    // Written straight from the mapping: no intermediate read buffer
+    const uint8_t* data = source.GetData();
+    size_t size = source.GetSize();
+    for (size_t offset = 0; offset < size; offset += kChunkSize) {
+        size_t n = std::min(kChunkSize, size - offset);
+        out.write(reinterpret_cast<const char*>(data + offset), static_cast<std::streamsize>(n));
+        if (!out) {
+            error = "write failed for " + destination;
+            return false;
+        }
+        if (hash) {
+            hash->Update(data + offset, n);
+        }
+        done.fetch_add(n, std::memory_order_relaxed);
+    }
+    method = CopyMethod::Stream;
+    return true;
+}
+
+#else
+
+bool TryReflink(const std::string& source, const std::string& destination) {
+#ifdef FICLONE
+    int in = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return false;
+    }
+    int out = ::open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        ::close(in);
+        return false;
+    }
+    bool cloned = ioctl(out, FICLONE, in) == 0;
+    ::close(out);
+    ::close(in);
+    if (!cloned) {
+        ::unlink(destination.c_str());
+    }
+    return cloned;
+#else
+    (void)source;
+    (void)destination;
+    return false;
+#endif
+}
+
+bool StreamCopy(const MappedFile& source, const std::string& sourcePath, const std::string& destination,
+                Sha256* hash, std::atomic<uint64_t>& done, CopyMethod& method, std::string& error) {
+    int in = ::open(sourcePath.c_str(), O_RDONLY | O_CLOEXEC);
+    int out = ::open(destination.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (in < 0 || out < 0) {
+        if (in >= 0) ::close(in);
+        if (out >= 0) ::close(out);
+        error = "could not create " + destination;
+        return false;
+    }
+
+#ifdef SYS_copy_file_range
+    bool useCopyRange = true;
+#else
+    bool useCopyRange = false;
+#endif
+    bool wroteFromUserSpace = false;
+
+    const uint8_t* data = source.GetData();
+    size_t size = source.GetSize();
+    bool ok = true;
+
+    for (size_t offset = 0; ok && offset < size; offset += kChunkSize) {
+        size_t n = std::min(kChunkSize, size - offset);
+        size_t copied = 0;
+
+#ifdef SYS_copy_file_range
+        // Let the kernel move the chunk; it may also share extents on NFS/CIFS/btrfs
+        while (useCopyRange && copied < n) {
+            int64_t inOffset = static_cast<int64_t>(offset + copied);
+            int64_t outOffset = inOffset;
+            long r = syscall(SYS_copy_file_range, in, &inOffset, out, &outOffset, n - copied, 0u);
+            if (r <= 0) {
+                // ENOSYS / EXDEV / EINVAL etc: not supported here, write the rest ourselves
+                useCopyRange = false;
+                break;
+            }
+            copied += static_cast<size_t>(r);
+        }
+#endif
+
+        while (copied < n) {
+            ssize_t w = ::pwrite(out, data + offset + copied, n - copied, static_cast<off_t>(offset + copied));
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = "write failed for " + destination;
+                ok = false;
+                break;
+            }
+            copied += static_cast<size_t>(w);
+            wroteFromUserSpace = true;
+        }
+
+        if (ok) {
+            // The chunk was just read by the copy, so hashing hits the page cache
+            if (hash) {
+                hash->Update(data + offset, n);
+            }
+            done.fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+
+    ::close(in);
+    if (::close(out) != 0 && ok) {
+        error = "write failed for " + destination;
+        ok = false;
+    }
+    method = wroteFromUserSpace ? CopyMethod::Stream : CopyMethod::CopyFileRange;
+    return ok;
+}
+
+#endif
+
+} // namespace
+
+InstallJob::InstallJob()
+    : m_future(m_promise.get_future().share())
+    , m_bytesDone(0)
+    , m_bytesTotal(0)
+{
+}
+
+bool InstallJob::IsDone() const {
+    return m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+float InstallJob::GetProgress() const {
+    uint64_t total = GetBytesTotal();
+    return total > 0 ? static_cast<float>(GetBytesDone()) / static_cast<float>(total) : 0.0f;
+}
+
+APKInstaller::APKInstaller()
+    : m_stopping(false)
+{
+    m_thread = std::thread(&APKInstaller::WorkerLoop, this);
+}
+
+APKInstaller::~APKInstaller() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+std::shared_ptr<InstallJob> APKInstaller::Submit(const InstallRequest& request) {
+    auto job = std::make_shared<InstallJob>();
+    job->m_request = request;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(job);
+    }
+    m_condition.notify_one();
+    return job;
+}
+
+void APKInstaller::WorkerLoop() {
+    Profiler::SetThreadName("APK installer");
+    for (;;) {
+        std::shared_ptr<InstallJob> job;
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;
+            }
+            job = m_queue.front();
+            m_queue.pop_front();
+            stopping = m_stopping;
+        }
+
+        InstallResult result;
+        if (stopping) {
+            // Shutting down: fail queued jobs instead of leaving their futures hanging
+            result.error = "installer shut down";
+        }
+        else {
+            try {
+                result = Install(*job);
+            }
+            catch (const std::exception& e) {
+                result.success = false;
+                result.error = e.what();
+            }
+        }
+        job->m_promise.set_value(std::move(result));
+    }
+}
+
+InstallResult APKInstaller::Install(InstallJob& job) {
+    PROFILE_ZONE("APKInstaller::Install");
+    const InstallRequest& request = job.m_request;
+    InstallResult result;
+
+    std::error_code ec;
+    if (!fs::is_regular_file(request.source, ec)) {
+        result.error = "APK file not found: " + request.source;
+        return result;
+    }
+    if (fs::path(request.source).extension() != ".apk") {
+        result.error = "Invalid APK file: " + request.source;
+        return result;
+    }
+
+    // An APK is a ZIP archive with a manifest; reject anything else before copying
+    {
+        ZipArchive archive;
+        if (!archive.Open(request.source) || !archive.FindEntry("AndroidManifest.xml")) {
+            result.error = "Invalid APK file: " + request.source;
+            return result;
+        }
+    }
+    result.info = APKManager::ExtractAPKInfo(request.source);
+
+    MappedFile source;
+    if (!source.Open(request.source)) {
+        result.error = "Could not read " + request.source;
+        return result;
+    }
+    const uint64_t size = source.GetSize();
+    job.m_bytesTotal = size;
+    result.bytes = size;
+
+    Sha256 hash;
+    std::string contentHash;
+    bool hashed = false;
+
+    // Only a blob of the same size can be a duplicate. In that case (or when the
+    // source is being moved anyway) hash first: a duplicate then costs one read
+    // of the source and no writes at all.
+    if (request.moveSource || request.mayBeStored) {
+        HashMapped(source, &hash, job.m_bytesDone);
+        contentHash = hash.FinalHex();
+        hashed = true;
+
+        std::string blobPath = BlobPath(request.storeDirectory, contentHash);
+        if (fs::exists(blobPath, ec)) {
+            source.Close();
+            if (request.moveSource) {
+                fs::remove(request.source, ec);
+            }
+            result.method = CopyMethod::Deduplicated;
+            MarkStored(result, blobPath, contentHash);
+            return result;
+        }
+
+        if (request.moveSource) {
+            // Windows can't rename a file that is still mapped
+            source.Close();
+            fs::rename(request.source, blobPath, ec);
+            if (!ec) {
+                result.method = CopyMethod::Move;
+                MarkStored(result, blobPath, contentHash);
+                return result;
+            }
+            // Different volume: copy it instead
+            if (!source.Open(request.source)) {
+                result.error = "Could not read " + request.source;
+                return result;
+            }
+        }
+        job.m_bytesTotal = size * 2;
+    }
+
+    // Build inside the store and rename into place, so a crash or a concurrent
+    // scan never sees a half-written blob
+    std::string tempPath = (fs::path(request.storeDirectory) / fs::path(request.source).filename()).string() + ".part";
+    fs::remove(tempPath, ec);
+
+    // The hash of a fresh APK is computed from the same chunks the copy reads
+    Sha256* copyHash = hashed ? nullptr : &hash;
+    bool placed = false;
+#ifndef _WIN32
+    if (TryReflink(request.source, tempPath)) {
+        result.method = CopyMethod::Reflink;
+        HashMapped(source, copyHash, job.m_bytesDone);
+        placed = true;
+    }
+#endif
+    if (!placed && request.allowHardLink && TryHardLink(request.source, tempPath)) {
+        result.method = CopyMethod::HardLink;
+        HashMapped(source, copyHash, job.m_bytesDone);
+        placed = true;
+    }
+    if (!placed) {
+#ifdef _WIN32
+        placed = StreamCopy(source, tempPath, copyHash, job.m_bytesDone, result.method, result.error);
+#else
+        placed = StreamCopy(source, request.source, tempPath, copyHash, job.m_bytesDone, result.method, result.error);
+#endif
+    }
+    source.Close();
+
+    if (!placed) {
+        fs::remove(tempPath, ec);
+        return result;
+    }
+    if (!hashed) {
+        contentHash = hash.FinalHex();
+    }
+
+    std::string blobPath = BlobPath(request.storeDirectory, contentHash);
+    if (fs::exists(blobPath, ec)) {
+        // Appeared after the size check (e.g. stored by another instance)
+        fs::remove(tempPath, ec);
+        result.method = CopyMethod::Deduplicated;
+    }
+    else {
+        fs::rename(tempPath, blobPath, ec);
+        if (ec) {
+            result.error = "Could not move " + tempPath + " into place: " + ec.message();
+            fs::remove(tempPath, ec);
+            return result;
+        }
+    }
+
+    if (request.moveSource) {
+        fs::remove(request.source, ec);
+    }
+    MarkStored(result, blobPath, contentHash);
+    return result;
+}
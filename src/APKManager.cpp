@@ -1,4 +1,14 @@
 #include "APKManager.h"
+#include "APKCatalog.h"
+#include "APKIndexCache.h"
+#include "APKInstaller.h"
+#include "APKScanner.h"
+#include "APKStore.h"
+#include "ThreadPool.h"
+#include "ZipArchive.h"
+#include "AXMLParser.h"
+#include "Profiler.h"
+#include "ResourceTable.h"
 #include <iostream>
 #include <fstream>
 #include <filesystem>
@@ -7,7 +17,15 @@
 
 namespace fs = std::filesystem;
 
-APKManager::APKManager() {
+APKManager::APKManager()
+    : m_catalog(std::make_unique<APKCatalog>())
+    , m_indexCache(std::make_unique<APKIndexCache>())
+    , m_store(std::make_unique<APKStore>())
+    , m_threadPool(std::make_unique<ThreadPool>())
+    , m_scanReported(true)
+    , m_installer(std::make_unique<APKInstaller>())
+{
+    m_scanner = std::make_unique<APKScanner>(*m_threadPool);
     m_installDir = "apks";
     
     // Create install directory if it doesn't exist
@@ -21,41 +39,106 @@ APKManager::APKManager() {
 APKManager::~APKManager() {
 }
 
+std::shared_ptr<InstallJob> APKManager::LoadAPKAsync(const std::string& filepath) {
+    return QueueInstall(filepath, false);
+}
+
+std::shared_ptr<InstallJob> APKManager::QueueInstall(const std::string& filepath, bool moveSource) {
+    // Validation, hashing and any copy all happen on the installer thread
+    InstallRequest request;
+    request.source = filepath;
+    request.name = fs::path(filepath).filename().string();
+    request.storeDirectory = GetStorePath();
+    request.moveSource = moveSource;
+    // Only a stored blob of the same size can make the install a duplicate
+    std::error_code sizeError;
+    uint64_t size = fs::file_size(filepath, sizeError);
+    request.mayBeStored = sizeError || m_store->HasBlobOfSize(size);
+    
+    std::shared_ptr<InstallJob> job = m_installer->Submit(request);
+    m_pendingInstalls.push_back(job);
+    return job;
+}
+
 bool APKManager::LoadAPK(const std::string& filepath) {
-    if (!fs::exists(filepath)) {
-        std::cerr << "APK file not found: " << filepath << std::endl;
-        return false;
-    }
+    std::shared_ptr<InstallJob> job = LoadAPKAsync(filepath);
+    job->GetFuture().wait();
     
-    // Check if it's a valid APK (basic check - should end with .apk)
-    if (filepath.substr(filepath.length() - 4) != ".apk") {
-        std::cerr << "Invalid APK file: " << filepath << std::endl;
-        return false;
+    // Installs are merged after the scan hands over the index
+    WaitForScan();
+    PollInstalls();
+    return job->GetFuture().get().success;
+}
+
+void APKManager::PollInstalls() {
+    PROFILE_ZONE("APKManager::PollInstalls");
+    // Merging during a scan would race the scan's index hand-over; finished
+    // jobs simply wait in the queue until the scan is done
+    if (!m_scanReported || m_pendingInstalls.empty()) {
+        return;
     }
     
-    // Extract APK info
-    APKInfo info = ExtractAPKInfo(filepath);
-    
-    // Copy to install directory
-    std::string destPath = m_installDir + "/" + fs::path(filepath).filename().string();
-    try {
-        fs::copy_file(filepath, destPath, fs::copy_options::overwrite_existing);
-        std::cout << "APK installed: " << info.name << std::endl;
+    bool indexChanged = false;
+    bool storeChanged = false;
+    auto it = m_pendingInstalls.begin();
+    while (it != m_pendingInstalls.end()) {
+        if (!(*it)->IsDone()) {
+            ++it;
+            continue;
+        }
         
-        // Add to installed list
-        info.filepath = destPath;
-        m_installedAPKs.push_back(info);
+        const InstallResult& result = (*it)->GetFuture().get();
+        if (result.success) {
+            const APKInfo& info = result.info;
+            if (result.method == CopyMethod::Deduplicated) {
+                std::cout << "APK installed: " << info.name << " (already stored)" << std::endl;
+            }
+            else {
+                std::cout << "APK installed: " << info.name << std::endl;
+            }
+            
+            // Reinstalling a name with different content may orphan its old blob
+            std::string released = m_store->Assign((*it)->GetRequest().name, info.contentHash, result.bytes);
+            if (!released.empty()) {
+                m_catalog->Remove(m_catalog->FindContentHash(released));
+                m_store->RemoveBlob(released);
+            }
+            storeChanged = true;
+            
+            if (m_catalog->FindContentHash(info.contentHash) == APKCatalog::kNotFound) {
+                m_catalog->Add(info);
+                
+                // Record it in the index so the next launch doesn't re-parse it
+                std::error_code sizeError;
+                std::error_code timeError;
+                uint64_t size = fs::file_size(info.filepath, sizeError);
+                int64_t mtime = fs::last_write_time(info.filepath, timeError).time_since_epoch().count();
+                if (!sizeError && !timeError) {
+                    m_indexCache->Store(info, size, mtime);
+                    indexChanged = true;
+                }
+            }
+        }
+        else {
+            std::cerr << "Error installing APK: " << result.error << std::endl;
+        }
         
-        return true;
+        if (m_installCallback) {
+            m_installCallback(result);
+        }
+        it = m_pendingInstalls.erase(it);
     }
-    catch (const std::exception& e) {
-        std::cerr << "Error installing APK: " << e.what() << std::endl;
-        return false;
+    
+    if (storeChanged) {
+        m_store->Save();
+    }
+    if (indexChanged) {
+        m_indexCache->Save(GetIndexPath());
     }
 }
 
-std::vector<APKInfo> APKManager::GetInstalledAPKs() const {
-    return m_installedAPKs;
+const APKCatalog& APKManager::GetCatalog() const {
+    return *m_catalog;
 }
 
 bool APKManager::LaunchAPK(const std::string& packageName) {
@@ -69,19 +152,19 @@ bool APKManager::LaunchAPK(const std::string& packageName) {
     std::cout << "NOTE: This is a simulated launcher. Full APK execution requires Android runtime." << std::endl;
     
     // Find APK
-    for (const auto& apk : m_installedAPKs) {
-        if (apk.packageName == packageName) {
-            std::cout << "APK found: " << apk.name << std::endl;
-            std::cout << "File: " << apk.filepath << std::endl;
-            
-            // In a real implementation, you would:
-            // 1. Extract APK contents
-            // 2. Parse AndroidManifest.xml
-            // 3. Launch in Android container/VM
-            // 4. Render in emulator window
-            
-            return true;
-        }
+    size_t index = m_catalog->FindPackage(packageName);
+    if (index != APKCatalog::kNotFound) {
+        APKView apk = m_catalog->GetView(index);
+        std::cout << "APK found: " << apk.name << std::endl;
+        std::cout << "File: " << apk.filepath << std::endl;
+        
+        // In a real implementation, you would:
+        // 1. Extract APK contents
+        // 2. Parse AndroidManifest.xml
+        // 3. Launch in Android container/VM
+        // 4. Render in emulator window
+        
+        return true;
     }
     
     std::cerr << "APK not found: " << packageName << std::endl;
@@ -89,21 +172,72 @@ bool APKManager::LaunchAPK(const std::string& packageName) {
 }
 
 APKInfo APKManager::ExtractAPKInfo(const std::string& filepath) {
+    PROFILE_ZONE("APKManager::ExtractAPKInfo");
+    // Filename-derived values are the fallback when the manifest can't be read
     APKInfo info;
     info.filepath = filepath;
     info.name = fs::path(filepath).stem().string();
     info.packageName = GetPackageNameFromPath(filepath);
     info.version = "1.0.0"; // Default version
     
-    // NOTE: Real implementation would:
-    // 1. Extract APK (it's a ZIP file)
-    // 2. Parse AndroidManifest.xml
-    // 3. Extract package name, version, app name, etc.
+    // Only the central directory and the entries read below are paged in
+    ZipArchive archive;
+    if (!archive.Open(filepath)) {
+        return info;
+    }
+    
+    const ZipEntry* manifestEntry = archive.FindEntry("AndroidManifest.xml");
+    if (!manifestEntry) {
+        std::cerr << "APK has no AndroidManifest.xml: " << filepath << std::endl;
+        return info;
+    }
+    
+    std::vector<uint8_t> scratch;
+    ByteView manifestData;
+    ManifestInfo manifest;
+    if (!archive.ReadEntry(*manifestEntry, scratch, manifestData) ||
+        !AXMLParser::ParseManifest(manifestData.data, manifestData.size, manifest)) {
+        std::cerr << "Could not parse AndroidManifest.xml in: " << filepath << std::endl;
+        return info;
+    }
+    
+    info.packageName = manifest.packageName;
+    info.versionCode = manifest.versionCode;
+    info.minSdkVersion = manifest.minSdkVersion;
+    info.targetSdkVersion = manifest.targetSdkVersion;
+    if (!manifest.versionName.empty()) {
+        info.version = manifest.versionName;
+    }
+    else if (manifest.versionCode != 0) {
+        info.version = std::to_string(manifest.versionCode);
+    }
+    
+    // Labels are usually @string references; resources.arsc is normally stored
+    // uncompressed, so this is a lookup straight into the mapping
+    if (!manifest.label.empty()) {
+        info.name = manifest.label;
+    }
+    else if (manifest.labelResId != 0) {
+        const ZipEntry* resourcesEntry = archive.FindEntry("resources.arsc");
+        ByteView resourcesData;
+        std::string label;
+        if (resourcesEntry &&
+            archive.ReadEntry(*resourcesEntry, scratch, resourcesData) &&
+            ResourceTable::ResolveString(resourcesData.data, resourcesData.size, manifest.labelResId, label) &&
+            !label.empty()) {
+            info.name = label;
+        }
+    }
     
     return info;
 }
 
 void APKManager::SetInstallDirectory(const std::string& dir) {
+    // The constructor already scanned the default directory; don't walk it again
+    if (dir == m_installDir && fs::exists(m_installDir)) {
+        return;
+    }
+    
     m_installDir = dir;
     if (!fs::exists(m_installDir)) {
         fs::create_directories(m_installDir);
@@ -112,23 +246,101 @@ void APKManager::SetInstallDirectory(const std::string& dir) {
 }
 
 void APKManager::ScanInstalledAPKs() {
-    m_installedAPKs.clear();
+    PROFILE_ZONE("APKManager::ScanInstalledAPKs");
+    m_catalog->Clear();
     
     if (!fs::exists(m_installDir)) {
         return;
     }
     
-    for (const auto& entry : fs::directory_iterator(m_installDir)) {
-        if (entry.is_regular_file() && entry.path().extension() == ".apk") {
-            APKInfo info = ExtractAPKInfo(entry.path().string());
-            m_installedAPKs.push_back(info);
+    // The manifest decides which stored blobs are installed
+    if (!m_store->Open(GetStorePath())) {
+        std::cerr << "Error: The APK store in " << GetStorePath()
+                  << " can't be updated; installs will not survive a restart" << std::endl;
+    }
+    
+    // Unchanged APKs come back from the index immediately; the rest are parsed
+    // on the thread pool and picked up by PollScan() as they finish
+    m_scanReported = false;
+    m_scanner->Start(GetStorePath(), GetIndexPath(), &APKManager::ExtractAPKInfo);
+    
+    AdoptLooseAPKs();
+}
+
+void APKManager::AdoptLooseAPKs() {
+    PROFILE_ZONE("APKManager::AdoptLooseAPKs");
+    // APKs dropped straight into the install directory (or left there by older
+    // versions) are moved into the store in the background, deduplicating them
+    std::error_code ec;
+    for (fs::directory_iterator it(m_installDir, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code typeError;
+        if (it->is_regular_file(typeError) && it->path().extension() == ".apk") {
+            QueueInstall(it->path().string(), true);
         }
     }
 }
 
+void APKManager::PollScan() {
+    PROFILE_ZONE("APKManager::PollScan");
+    if (m_scanReported) {
+        return;
+    }
+    
+    std::vector<APKInfo> scanned;
+    APKScanProgress progress = m_scanner->Poll(scanned);
+    if (scanned.empty() && !progress.finished) {
+        return;
+    }
+    
+    // Blobs are named by their hash; ones no name refers to (e.g. left behind
+    // by an interrupted reinstall) are not installed
+    std::vector<APKInfo> added;
+    for (auto& info : scanned) {
+        info.contentHash = fs::path(info.filepath).stem().string();
+        if (m_store->IsReferenced(info.contentHash)) {
+            added.push_back(std::move(info));
+        }
+    }
+    for (const auto& info : added) {
+        m_catalog->Add(info);
+    }
+    
+    if (progress.finished) {
+        std::unique_ptr<APKIndexCache> index = m_scanner->TakeIndex();
+        if (index) {
+            m_indexCache = std::move(index);
+        }
+        if (m_store->PruneMissing() > 0) {
+            m_store->Save();
+        }
+        m_scanReported = true;
+    }
+    
+    if (m_scanCallback) {
+        m_scanCallback(added, progress);
+    }
+}
+
+void APKManager::WaitForScan() {
+    m_scanner->Wait();
+    PollScan();
+}
+
+bool APKManager::IsScanning() const {
+    return m_scanner->IsRunning();
+}
+
+std::string APKManager::GetIndexPath() const {
+    return (fs::path(m_installDir) / ".apkindex").string();
+}
+
+std::string APKManager::GetStorePath() const {
+    return (fs::path(m_installDir) / ".store").string();
+}
+
 std::string APKManager::GetPackageNameFromPath(const std::string& filepath) {
     // Extract a simple package name from filename
-    // In real implementation, parse from AndroidManifest.xml
+    // Only used when the APK's AndroidManifest.xml can't be parsed
     std::string filename = fs::path(filepath).stem().string();
     
     // Convert to package-like format (lowercase, dots)
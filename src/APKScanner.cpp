@@ -0,0 +1,188 @@
+#include "APKScanner.h"
+#include "APKIndexCache.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+struct APKScanner::ScanState {
+    std::string directory;
+    std::string indexPath;
+    ExtractFunc extract;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<APKInfo> pending;
+    std::unique_ptr<APKIndexCache> index;
+    size_t completed = 0;
+    size_t total = 0;
+    size_t outstanding = 0;
+    size_t parsed = 0;
+    bool finished = false;
+
+    std::atomic<bool> cancelled{false};
+};
+
+APKScanner::APKScanner(ThreadPool& pool)
+    : m_pool(pool)
+{
+}
+
+APKScanner::~APKScanner() {
+    Cancel();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void APKScanner::Start(const std::string& directory, const std::string& indexPath, ExtractFunc extract) {
+    Cancel();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    m_state = std::make_shared<ScanState>();
+    m_state->directory = directory;
+    m_state->indexPath = indexPath;
+    m_state->extract = std::move(extract);
+    m_state->index = std::make_unique<APKIndexCache>();
+    m_thread = std::thread(&APKScanner::Run, m_state, &m_pool);
+}
+
+void APKScanner::Cancel() {
+    if (m_state) {
+        m_state->cancelled = true;
+    }
+}
+
+APKScanProgress APKScanner::Poll(std::vector<APKInfo>& out) {
+    APKScanProgress progress;
+    if (!m_state) {
+        progress.finished = true;
+        return progress;
+    }
+
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    for (auto& info : m_state->pending) {
+        out.push_back(std::move(info));
+    }
+    m_state->pending.clear();
+
+    progress.completed = m_state->completed;
+    progress.total = m_state->total;
+    progress.finished = m_state->finished;
+    return progress;
+}
+
+void APKScanner::Wait() {
+    if (!m_state) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->changed.wait(lock, [this] { return m_state->finished; });
+}
+
+bool APKScanner::IsRunning() const {
+    if (!m_state) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return !m_state->finished;
+}
+
+std::unique_ptr<APKIndexCache> APKScanner::TakeIndex() {
+    if (!m_state) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    if (!m_state->finished) {
+        return nullptr;
+    }
+    return std::move(m_state->index);
+}
+
+void APKScanner::Run(std::shared_ptr<ScanState> state, ThreadPool* pool) {
+    Profiler::SetThreadName("APK scanner");
+    PROFILE_ZONE("APKScanner::Run");
+    const bool useIndex = !state->indexPath.empty();
+    APKIndexCache previous;
+    if (useIndex) {
+        previous.Load(state->indexPath);
+    }
+
+    std::error_code ec;
+    for (fs::directory_iterator it(state->directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (state->cancelled) {
+            break;
+        }
+
+        const fs::directory_entry& entry = *it;
+        std::error_code typeError;
+        if (!entry.is_regular_file(typeError) || entry.path().extension() != ".apk") {
+            continue;
+        }
+
+        std::string path = entry.path().string();
+        std::error_code sizeError;
+        std::error_code timeError;
+        uint64_t size = entry.file_size(sizeError);
+        int64_t mtime = entry.last_write_time(timeError).time_since_epoch().count();
+        bool haveStat = !sizeError && !timeError;
+
+        // Cache hits are published straight from the walk
+        APKInfo cached;
+        if (useIndex && haveStat && previous.Lookup(path, size, mtime, cached)) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->index->Store(cached, size, mtime);
+            state->pending.push_back(std::move(cached));
+            ++state->total;
+            ++state->completed;
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            ++state->total;
+            ++state->outstanding;
+        }
+
+        pool->Submit([state, path, size, mtime, haveStat] {
+            if (!state->cancelled) {
+                APKInfo info = state->extract(path);
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (haveStat) {
+                    state->index->Store(info, size, mtime);
+                }
+                state->pending.push_back(std::move(info));
+                ++state->completed;
+                ++state->parsed;
+            }
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            --state->outstanding;
+            state->changed.notify_all();
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->changed.wait(lock, [&state] { return state->outstanding == 0; });
+    }
+
+    // All workers are done with the index now. Only rewrite it when something
+    // was added, changed or removed, and without holding the lock Poll() needs.
+    if (useIndex && !state->cancelled &&
+        (state->parsed > 0 || state->index->GetEntryCount() != previous.GetEntryCount())) {
+        state->index->Save(state->indexPath);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->finished = true;
+    }
+    state->changed.notify_all();
+}
@@ -0,0 +1,241 @@
+#include "APKStore.h"
+#include "AtomicFile.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <system_error>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+constexpr int kManifestVersion = 1;
+
+// Hashes come from a file on disk; never let one name a path outside the store
+bool IsValidHash(const std::string& hash) {
+    if (hash.size() != 64) {
+        return false;
+    }
+    for (char c : hash) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+APKStore::APKStore()
+    : m_readOnly(false)
+{
+}
+
+APKStore::~APKStore() {
+}
+
+bool APKStore::Open(const std::string& directory) {
+    m_directory = directory;
+    m_readOnly = false;
+    m_names.clear();
+    m_refCounts.clear();
+    m_blobSizes.clear();
+    m_sizeCounts.clear();
+
+    std::error_code ec;
+    fs::create_directories(m_directory, ec);
+    if (ec) {
+        std::cerr << "Error: Could not create APK store " << m_directory << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    bool usable = LoadManifest();
+
+    // One stat per stored blob here saves listing the store on every install
+    for (const auto& count : m_refCounts) {
+        uint64_t size = fs::file_size(GetBlobPath(count.first), ec);
+        if (!ec) {
+            AddBlobSize(count.first, size);
+        }
+    }
+    return usable;
+}
+
+bool APKStore::LoadManifest() {
+    std::ifstream file(GetManifestPath());
+    if (!file.is_open()) {
+        // A fresh store
+        return true;
+    }
+
+    try {
+        json manifest;
+        file >> manifest;
+        if (!manifest.is_object() || manifest.value("version", 0) != kManifestVersion ||
+            !manifest.contains("names") || !manifest["names"].is_object()) {
+            file.close();
+            return RecoverFromBlobs("unknown format");
+        }
+
+        for (const auto& item : manifest["names"].items()) {
+            if (!item.value().is_string()) {
+                continue;
+            }
+            std::string hash = item.value().get<std::string>();
+            if (IsValidHash(hash)) {
+                m_names[item.key()] = hash;
+                ++m_refCounts[hash];
+            }
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        m_names.clear();
+        m_refCounts.clear();
+        file.close();
+        return RecoverFromBlobs(e.what());
+    }
+}
+
+bool APKStore::RecoverFromBlobs(const std::string& reason) {
+    // Keep the damaged file: it is the only record of the install names
+    std::string path = GetManifestPath();
+    std::string backupPath = path + ".bad";
+    std::cerr << "Error: APK store manifest " << path << " is damaged (" << reason << ")" << std::endl;
+    std::error_code ec;
+    fs::copy_file(path, backupPath, fs::copy_options::overwrite_existing, ec);
+    if (ec) {
+        std::cerr << "Error: Could not back it up to " << backupPath << " (" << ec.message()
+                  << "); it is left as is and installs are not recorded until it is fixed" << std::endl;
+        m_readOnly = true;
+    }
+
+    // Every blob stays installed, named by its hash until reinstalled under a real name
+    for (fs::directory_iterator it(m_directory, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string hash = it->path().stem().string();
+        if (it->path().extension() == ".apk" && IsValidHash(hash)) {
+            m_names[hash + ".apk"] = hash;
+            ++m_refCounts[hash];
+        }
+    }
+    if (!m_readOnly) {
+        std::cerr << "Recovered " << m_names.size() << " stored APKs under their content hashes; "
+                  << "the original names are in " << backupPath << std::endl;
+    }
+    return !m_readOnly;
+}
+
+bool APKStore::Save() const {
+    if (m_readOnly) {
+        std::cerr << "Error: Not saving the APK store manifest over the damaged " << GetManifestPath() << std::endl;
+        return false;
+    }
+    json names = json::object();
+    for (const auto& pair : m_names) {
+        names[pair.first] = pair.second;
+    }
+    json manifest;
+    manifest["version"] = kManifestVersion;
+    manifest["names"] = std::move(names);
+
+    // The manifest is the only record of which names exist, so it must never
+    // be left half-written
+    std::string path = GetManifestPath();
+    if (!WriteFileAtomic(path, manifest.dump(4))) {
+        std::cerr << "Error: Could not write APK store manifest " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string APKStore::GetBlobPath(const std::string& hash) const {
+    return (fs::path(m_directory) / (hash + ".apk")).string();
+}
+
+std::string APKStore::GetManifestPath() const {
+    return (fs::path(m_directory) / "manifest.json").string();
+}
+
+std::string APKStore::Assign(const std::string& name, const std::string& hash, uint64_t size) {
+    std::string released;
+    auto it = m_names.find(name);
+    if (it != m_names.end()) {
+        if (it->second == hash) {
+            return released;
+        }
+        auto count = m_refCounts.find(it->second);
+        if (count != m_refCounts.end() && --count->second == 0) {
+            released = it->second;
+            m_refCounts.erase(count);
+            RemoveBlobSize(released);
+        }
+        it->second = hash;
+    }
+    else {
+        m_names.emplace(name, hash);
+    }
+    if (++m_refCounts[hash] == 1) {
+        AddBlobSize(hash, size);
+    }
+    return released;
+}
+
+bool APKStore::IsReferenced(const std::string& hash) const {
+    return m_refCounts.find(hash) != m_refCounts.end();
+}
+
+bool APKStore::HasBlobOfSize(uint64_t size) const {
+    return m_sizeCounts.find(size) != m_sizeCounts.end();
+}
+
+void APKStore::AddBlobSize(const std::string& hash, uint64_t size) {
+    if (m_blobSizes.emplace(hash, size).second) {
+        ++m_sizeCounts[size];
+    }
+}
+
+void APKStore::RemoveBlobSize(const std::string& hash) {
+    auto blob = m_blobSizes.find(hash);
+    if (blob == m_blobSizes.end()) {
+        return;
+    }
+    auto count = m_sizeCounts.find(blob->second);
+    if (count != m_sizeCounts.end() && --count->second == 0) {
+        m_sizeCounts.erase(count);
+    }
+    m_blobSizes.erase(blob);
+}
+
+void APKStore::RemoveBlob(const std::string& hash) {
+    if (!IsValidHash(hash) || IsReferenced(hash)) {
+        return;
+    }
+    std::error_code ec;
+    fs::remove(GetBlobPath(hash), ec);
+}
+
+size_t APKStore::PruneMissing() {
+    size_t removed = 0;
+    for (auto count = m_refCounts.begin(); count != m_refCounts.end();) {
+        std::error_code ec;
+        if (fs::exists(GetBlobPath(count->first), ec)) {
+            ++count;
+            continue;
+        }
+
+        for (auto it = m_names.begin(); it != m_names.end();) {
+            if (it->second == count->first) {
+                it = m_names.erase(it);
+                ++removed;
+            }
+            else {
+                ++it;
+            }
+        }
+        RemoveBlobSize(count->first);
+        count = m_refCounts.erase(count);
+    }
+    return removed;
+}
@@ -0,0 +1,243 @@
+#include "AXMLParser.h"
+#include "ByteReader.h"
+#include "ResStringPool.h"
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+constexpr uint16_t kChunkStringPool = 0x0001;
+constexpr uint16_t kChunkXml = 0x0003;
+constexpr uint16_t kChunkXmlStartElement = 0x0102;
+constexpr uint16_t kChunkXmlEndElement = 0x0103;
+constexpr uint16_t kChunkXmlResourceMap = 0x0180;
+
+constexpr uint8_t kTypeReference = 0x01;
+constexpr uint8_t kTypeString = 0x03;
+constexpr uint8_t kTypeIntDec = 0x10;
+constexpr uint8_t kTypeIntHex = 0x11;
+
+constexpr uint32_t kNoIndex = 0xffffffffu;
+
+// android:* attribute resource IDs (android.R.attr). Matching on these rather than
+// on the name string keeps working when tools strip or obfuscate attribute names.
+constexpr uint32_t kAttrLabel = 0x01010001;
+constexpr uint32_t kAttrMinSdkVersion = 0x0101020c;
+constexpr uint32_t kAttrVersionCode = 0x0101021b;
+constexpr uint32_t kAttrVersionName = 0x0101021c;
+constexpr uint32_t kAttrTargetSdkVersion = 0x01010270;
+
+enum Token : uint8_t {
+    kTokenUnresolved = 0,
+    kTokenOther,
+    kTokenManifest,
+    kTokenUsesSdk,
+    kTokenApplication,
+    kTokenPackage,
+    kTokenLabel,
+    kTokenMinSdkVersion,
+    kTokenTargetSdkVersion,
+    kTokenVersionCode,
+    kTokenVersionName,
+};
+
+struct TokenName {
+    Token token;
+    std::string_view name;
+};
+
+constexpr TokenName kTokenNames[] = {
+    {kTokenManifest, "manifest"},
+    {kTokenUsesSdk, "uses-sdk"},
+    {kTokenApplication, "application"},
+    {kTokenPackage, "package"},
+    {kTokenLabel, "label"},
+    {kTokenMinSdkVersion, "minSdkVersion"},
+    {kTokenTargetSdkVersion, "targetSdkVersion"},
+    {kTokenVersionCode, "versionCode"},
+    {kTokenVersionName, "versionName"},
+};
+
+// Interns string-pool indices to tokens so each distinct name is compared at most once.
+// Lives on the stack; names past the memo range are simply compared every time.
+class TokenMemo {
+public:
+    explicit TokenMemo(const ResStringPool& pool) : m_pool(pool) {
+        std::memset(m_memo, kTokenUnresolved, sizeof(m_memo));
+    }
+
+    Token Resolve(uint32_t index) {
+        if (index < kMemoSize) {
+            if (m_memo[index] == kTokenUnresolved) {
+                m_memo[index] = Lookup(index);
+            }
+            return static_cast<Token>(m_memo[index]);
+        }
+        return Lookup(index);
+    }
+
+private:
+    static constexpr uint32_t kMemoSize = 512;
+    const ResStringPool& m_pool;
+    uint8_t m_memo[kMemoSize];
+
+    Token Lookup(uint32_t index) const {
+        for (const TokenName& tn : kTokenNames) {
+            if (m_pool.Equals(index, tn.name)) {
+                return tn.token;
+            }
+        }
+        return kTokenOther;
+    }
+};
+
+Token TokenForResId(uint32_t resId) {
+    switch (resId) {
+        case kAttrLabel: return kTokenLabel;
+        case kAttrMinSdkVersion: return kTokenMinSdkVersion;
+        case kAttrTargetSdkVersion: return kTokenTargetSdkVersion;
+        case kAttrVersionCode: return kTokenVersionCode;
+        case kAttrVersionName: return kTokenVersionName;
+        default: return kTokenOther;
+    }
+}
+
+// Integer attribute, also accepting numeric strings (e.g. minSdkVersion="21")
+int64_t ReadIntValue(const ResStringPool& pool, uint8_t type, uint32_t data, uint32_t rawValue) {
+    if (type == kTypeIntDec || type == kTypeIntHex) {
+        return static_cast<int32_t>(data);
+    }
+    if (type == kTypeString) {
+        std::string text = pool.Get(rawValue != kNoIndex ? rawValue : data);
+        int64_t value = 0;
+        for (char c : text) {
+            if (c < '0' || c > '9') {
+                return 0;
+            }
+            value = value * 10 + (c - '0');
+        }
+        return value;
+    }
+    return 0;
+}
+
+} // namespace
+
+bool AXMLParser::ParseManifest(const uint8_t* data, size_t size, ManifestInfo& info) {
+    if (size < 8 || ReadLE16(data) != kChunkXml) {
+        return false;
+    }
+    uint16_t fileHeaderSize = ReadLE16(data + 2);
+    uint32_t fileSize = ReadLE32(data + 4);
+    if (fileSize < size) {
+        size = fileSize;
+    }
+
+    ResStringPool pool;
+    bool havePool = false;
+    TokenMemo memo(pool);
+    const uint8_t* resMap = nullptr;
+    uint32_t resMapCount = 0;
+
+    bool foundManifest = false;
+    int depth = 0;
+    size_t pos = fileHeaderSize;
+
+    while (pos + 8 <= size) {
+        const uint8_t* chunk = data + pos;
+        uint16_t type = ReadLE16(chunk);
+        uint16_t headerSize = ReadLE16(chunk + 2);
+        uint32_t chunkSize = ReadLE32(chunk + 4);
+        if (chunkSize < 8 || headerSize > chunkSize || chunkSize > size - pos) {
+            break;
+        }
+
+        if (type == kChunkStringPool && !havePool) {
+            havePool = pool.Init(chunk, chunkSize);
+            if (!havePool) {
+                return false;
+            }
+        }
+        else if (type == kChunkXmlResourceMap) {
+            resMap = chunk + headerSize;
+            resMapCount = (chunkSize - headerSize) / 4;
+        }
+        else if (type == kChunkXmlEndElement) {
+            --depth;
+        }
+        else if (type == kChunkXmlStartElement && havePool) {
+            ++depth;
+
+            // ResXMLTree_attrExt follows the node header
+            const uint8_t* ext = chunk + headerSize;
+            if (chunkSize - headerSize < 20) {
+                break;
+            }
+            uint32_t elementName = ReadLE32(ext + 4);
+            uint16_t attrStart = ReadLE16(ext + 8);
+            uint16_t attrSize = ReadLE16(ext + 10);
+            uint16_t attrCount = ReadLE16(ext + 12);
+
+            Token element = memo.Resolve(elementName);
+            bool interesting = (element == kTokenManifest && depth == 1) ||
+                               ((element == kTokenUsesSdk || element == kTokenApplication) && depth == 2);
+
+            if (interesting) {
+                if (attrSize < 20 || headerSize + attrStart + static_cast<size_t>(attrSize) * attrCount > chunkSize) {
+                    break;
+                }
+
+                const uint8_t* attr = ext + attrStart;
+                for (uint16_t i = 0; i < attrCount; ++i, attr += attrSize) {
+                    uint32_t nameIndex = ReadLE32(attr + 4);
+                    uint32_t rawValue = ReadLE32(attr + 8);
+                    uint8_t valueType = attr[15];
+                    uint32_t valueData = ReadLE32(attr + 16);
+
+                    Token name = (resMap && nameIndex < resMapCount)
+                        ? TokenForResId(ReadLE32(resMap + nameIndex * 4))
+                        : memo.Resolve(nameIndex);
+
+                    if (element == kTokenManifest) {
+                        if (name == kTokenPackage && valueType == kTypeString) {
+                            info.packageName = pool.Get(valueData);
+                        }
+                        else if (name == kTokenVersionCode) {
+                            info.versionCode = ReadIntValue(pool, valueType, valueData, rawValue);
+                        }
+                        else if (name == kTokenVersionName && valueType == kTypeString) {
+                            info.versionName = pool.Get(valueData);
+                        }
+                    }
+                    else if (element == kTokenUsesSdk) {
+                        if (name == kTokenMinSdkVersion) {
+                            info.minSdkVersion = static_cast<int>(ReadIntValue(pool, valueType, valueData, rawValue));
+                        }
+                        else if (name == kTokenTargetSdkVersion) {
+                            info.targetSdkVersion = static_cast<int>(ReadIntValue(pool, valueType, valueData, rawValue));
+                        }
+                    }
+                    else if (name == kTokenLabel) {
+                        if (valueType == kTypeString) {
+                            info.label = pool.Get(valueData);
+                        }
+                        else if (valueType == kTypeReference) {
+                            info.labelResId = valueData;
+                        }
+                    }
+                }
+
+                if (element == kTokenManifest) {
+                    foundManifest = true;
+                }
+                else if (element == kTokenApplication) {
+                    break;
+                }
+            }
+        }
+
+        pos += chunkSize;
+    }
+
+    return foundManifest && !info.packageName.empty();
+}
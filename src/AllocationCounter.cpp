@@ -0,0 +1,139 @@
+#include "AllocationCounter.h"
+
+#ifdef EMULATOR_ALLOCATION_CHECK
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+
+std::atomic<uint64_t> g_allocations(0);
+
+void* AlignedAlloc(std::size_t size, std::size_t alignment) {
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    void* p = nullptr;
+    if (alignment < sizeof(void*)) {
+        alignment = sizeof(void*);
+    }
+    return posix_memalign(&p, alignment, size) == 0 ? p : nullptr;
+#endif
+}
+
+void AlignedFree(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+// The standard loop: on failure, let the new-handler free memory (or throw)
+// and try again; without a handler, throw
+template <typename Alloc>
+void* AllocOrThrow(Alloc alloc) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    for (;;) {
+        if (void* p = alloc()) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+} // namespace
+
+bool AllocationCounter::IsEnabled() {
+    return true;
+}
+
+uint64_t AllocationCounter::GetCount() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+// Replacements for the global allocation functions. Every form forwards to
+// malloc/free so the pairs stay consistent; the nothrow forms go through the
+// throwing ones, as the standard's default versions do.
+
+void* operator new(std::size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    return AllocOrThrow([size] { return std::malloc(size); });
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (size == 0) {
+        size = 1;
+    }
+    return AllocOrThrow([size, alignment] { return AlignedAlloc(size, static_cast<std::size_t>(alignment)); });
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size, alignment);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return operator new(size, alignment, std::nothrow);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { AlignedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { AlignedFree(p); }
+
+#else
+
+bool AllocationCounter::IsEnabled() {
+    return false;
+}
+
+uint64_t AllocationCounter::GetCount() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include "AtomicFile.h"
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Write 'contents' to 'tempPath', make it durable, then move it over 'filepath'
+#ifdef _WIN32
+
+bool WriteAndReplace(const std::string& tempPath, const std::string& filepath, const std::string& contents) {
+    std::wstring wideTemp = fs::path(tempPath).wstring();
+    HANDLE file = CreateFileW(wideTemp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    DWORD written = 0;
+    bool ok = WriteFile(file, contents.data(), static_cast<DWORD>(contents.size()), &written, nullptr) &&
+              written == contents.size() && FlushFileBuffers(file);
+    CloseHandle(file);
+    // WRITE_THROUGH: returns once the rename itself is on disk
+    return ok && MoveFileExW(wideTemp.c_str(), fs::path(filepath).wstring().c_str(),
+                             MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+}
+
+#else
+
+bool WriteAndReplace(const std::string& tempPath, const std::string& filepath, const std::string& contents) {
+    int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    const char* data = contents.data();
+    size_t left = contents.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, data, left);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            ::close(fd);
+            return false;
+        }
+        data += n;
+        left -= static_cast<size_t>(n);
+    }
+    bool ok = ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || ::rename(tempPath.c_str(), filepath.c_str()) != 0) {
+        return false;
+    }
+
+    // The rename lives in the directory; sync it too (best effort)
+    fs::path directory = fs::path(filepath).parent_path();
+    int dirFd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
+
+#endif
+
+} // namespace
+
+bool WriteFileAtomic(const std::string& filepath, const std::string& contents) {
+    std::string tempPath = filepath + ".tmp";
+    if (!WriteAndReplace(tempPath, filepath, contents)) {
+        std::error_code ec;
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,305 @@
+#include "Benchmarks.h"
+#include "APKManager.h"
+#include "APKScanner.h"
+#include "DrawList.h"
+#include "FrameTelemetry.h"
+#include "GuestFramebuffer.h"
+#include "PixelConvert.h"
+#include "TestPattern.h"
+#include "TextRenderer.h"
+#include "ThreadPool.h"
+#include "VirtualList.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+double ScanOnce(const std::string& directory, size_t threads, size_t& apkCount) {
+    ThreadPool pool(threads);
+    APKScanner scanner(pool);
+
+    auto start = std::chrono::steady_clock::now();
+    scanner.Start(directory, std::string(), &APKManager::ExtractAPKInfo);
+    scanner.Wait();
+    auto end = std::chrono::steady_clock::now();
+
+    std::vector<APKInfo> results;
+    apkCount = scanner.Poll(results).total;
+    return std::chrono::duration<double>(end - start).count();
+}
+
+struct ListResult {
+    LatencyHistogram scroll;    // Per-frame cost while gliding through the list
+    LatencyHistogram filter;    // Per-frame cost while filters are being applied
+    size_t filterFrames = 0;
+    size_t maxVertices = 0;
+};
+
+// One UI frame of the list: animate, advance the filter, rebuild if needed
+uint64_t ListFrame(VirtualList& view, DrawList& list, const std::vector<std::string_view>& names, size_t& maxVertices) {
+    auto start = std::chrono::steady_clock::now();
+    view.Update(1.0f / 60.0f);
+    view.SetItems(&names, 1);
+    if (view.IsDirty()) {
+        view.Build(list);
+    }
+    auto end = std::chrono::steady_clock::now();
+    maxVertices = std::max(maxVertices, list.GetVertexCount());
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+}
+
+ListResult MeasureList(TextRenderer& text, size_t entries) {
+    static const char* const words[] = {"Racer", "Puzzle", "Quest", "Arena", "Farm", "Legends", "Tycoon", "Runner"};
+    std::vector<std::string> storage;
+    storage.reserve(entries);
+    char name[64];
+    for (size_t i = 0; i < entries; ++i) {
+        std::snprintf(name, sizeof(name), "Game %06zu %s %s", i, words[i % 8], words[(i / 8) % 8]);
+        storage.emplace_back(name);
+    }
+    std::vector<std::string_view> names(storage.begin(), storage.end());
+
+    ListResult result;
+    VirtualList view(text);
+    DrawList list(text);
+    view.SetBounds({400, 100, 400, 520});
+    view.SetItems(&names, 1);
+
+    // Flick through the whole list and back, a new flick every second
+    const int frames = 1200;
+    for (int frame = 0; frame < frames; ++frame) {
+        if (frame % 60 == 0) {
+            float direction = (frame / 300) % 2 == 0 ? 1.0f : -1.0f;
+            view.ScrollRows(direction * static_cast<float>(entries) / 4.0f);
+        }
+        result.scroll.Record(ListFrame(view, list, names, result.maxVertices));
+    }
+
+    // Type a filter one character at a time, running frames until each pass ends
+    static const char* const keys[] = {"g", "a", "m", "e", " ", "0", "0", "1"};
+    for (const char* key : keys) {
+        view.AppendFilter(key);
+        do {
+            result.filter.Record(ListFrame(view, list, names, result.maxVertices));
+            ++result.filterFrames;
+        } while (view.IsFiltering());
+    }
+    return result;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Converter throughput for one format at the current SIMD level, in MB/s of RGBA output
+double MeasureConvert(const GuestFrame& frame, std::vector<uint32_t>& out, int frames) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        const uint8_t* src = static_cast<const uint8_t*>(frame.pixels);
+        for (int y = 0; y < frame.height; ++y) {
+            PixelConvert::ConvertRow(frame.format, src + static_cast<size_t>(y) * frame.pitch,
+                                     out.data() + static_cast<size_t>(y) * frame.width, static_cast<size_t>(frame.width));
+        }
+    }
+    double seconds = SecondsSince(start);
+    double bytes = static_cast<double>(out.size()) * 4.0 * frames;
+    return seconds > 0.0 ? bytes / seconds / 1e6 : 0.0;
+}
+
+} // namespace
+
+int Benchmarks::RunAPKScan(const std::string& directory) {
+    if (!fs::is_directory(directory)) {
+        std::cerr << "Not a directory: " << directory << std::endl;
+        return 1;
+    }
+
+    size_t maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0) {
+        maxThreads = 4;
+    }
+
+    // Warm-up pass so every thread count sees the same page-cache state
+    size_t apkCount = 0;
+    ScanOnce(directory, maxThreads, apkCount);
+    if (apkCount == 0) {
+        std::cerr << "No .apk files in " << directory << std::endl;
+        return 1;
+    }
+
+    std::printf("APK scan benchmark: %zu APKs in %s\n", apkCount, directory.c_str());
+    std::printf("%8s %12s %14s %9s\n", "threads", "time (ms)", "APKs/sec", "speedup");
+
+    double baseline = 0.0;
+    std::vector<size_t> threadCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    for (size_t threads : threadCounts) {
+        double seconds = ScanOnce(directory, threads, apkCount);
+        double rate = seconds > 0.0 ? apkCount / seconds : 0.0;
+        if (baseline == 0.0) {
+            baseline = rate;
+        }
+        std::printf("%8zu %12.2f %14.0f %8.2fx\n", threads, seconds * 1000.0, rate,
+                    baseline > 0.0 ? rate / baseline : 0.0);
+    }
+    return 0;
+}
+
+int Benchmarks::RunVirtualList(size_t entries) {
+    // Software renderer on the windowless video driver, so the text path has a real atlas
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+    SDL_Window* window = SDL_CreateWindow("Benchmark", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                          1280, 720, SDL_WINDOW_HIDDEN);
+    SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE) : nullptr;
+    if (!renderer) {
+        std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
+        if (window) {
+            SDL_DestroyWindow(window);
+        }
+        SDL_Quit();
+        return 1;
+    }
+
+    std::vector<size_t> sizes;
+    for (size_t size = 1000; size < entries; size *= 10) {
+        sizes.push_back(size);
+    }
+    sizes.push_back(entries);
+
+    {
+        TextRenderer text(renderer);
+        std::printf("Virtual list benchmark: 400x520 viewport, 1200 scrolling frames per size\n");
+        std::printf("%9s %12s %12s %12s %10s %14s %14s\n", "entries", "mean (us)", "p99 (us)", "max (us)",
+                    "vertices", "filter frames", "filter p99");
+
+        for (size_t size : sizes) {
+            ListResult result = MeasureList(text, size);
+            std::printf("%9zu %12.1f %12llu %12llu %10zu %14zu %14llu\n", size, result.scroll.GetMean(),
+                        static_cast<unsigned long long>(result.scroll.GetPercentile(0.99)),
+                        static_cast<unsigned long long>(result.scroll.GetMax()), result.maxVertices,
+                        result.filterFrames, static_cast<unsigned long long>(result.filter.GetPercentile(0.99)));
+        }
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
+
+int Benchmarks::RunGuestUpload(int frames) {
+    frames = std::max(frames, 1);
+    static const GuestPixelFormat formats[] = {GuestPixelFormat::RGB565, GuestPixelFormat::BGRA8888};
+
+    // Converters alone, from the scalar code up to the best level this CPU has
+    SimdLevel best = PixelConvert::GetSupportedSimdLevel();
+    std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+    if (best == SimdLevel::NEON) {
+        levels.push_back(SimdLevel::NEON);
+    } else {
+        for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+            if (level <= best) {
+                levels.push_back(level);
+            }
+        }
+    }
+
+    std::printf("Pixel conversion: 1920x1080, %d frames per row\n", frames);
+    std::printf("%10s %8s %12s %9s\n", "format", "simd", "MB/s", "speedup");
+    std::vector<uint32_t> converted(1920 * 1080);
+    for (GuestPixelFormat format : formats) {
+        TestPattern pattern(1920, 1080, format);
+        const GuestFrame& frame = pattern.Render(0);
+        double baseline = 0.0;
+        for (SimdLevel level : levels) {
+            PixelConvert::ForceSimdLevel(level);
+            double rate = MeasureConvert(frame, converted, frames);
+            if (baseline == 0.0) {
+                baseline = rate;
+            }
+            std::printf("%10s %8s %12.0f %8.2fx\n", PixelConvert::GetFormatName(format),
+                        PixelConvert::GetSimdLevelName(level), rate, baseline > 0.0 ? rate / baseline : 0.0);
+        }
+    }
+    PixelConvert::ForceSimdLevel(best);
+
+    // Full uploads: lock, convert (and upscale), unlock, through the software renderer
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+    SDL_Window* window = SDL_CreateWindow("Benchmark", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                          1920, 1080, SDL_WINDOW_HIDDEN);
+    SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE) : nullptr;
+    if (!renderer) {
+        std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
+        if (window) {
+            SDL_DestroyWindow(window);
+        }
+        SDL_Quit();
+        return 1;
+    }
+
+    struct UploadCase {
+        int width;
+        int height;
+        bool softwareScaling;   // 2x integer upscale during the upload
+    };
+    static const UploadCase cases[] = {
+        {640, 480, false}, {640, 480, true}, {1280, 720, false}, {1920, 1080, false}
+    };
+
+    std::printf("\nStreaming texture upload (%s, software renderer), %d frames per row\n",
+                PixelConvert::GetSimdLevelName(best), frames);
+    std::printf("%10s %10s %6s %12s %12s\n", "size", "format", "scale", "frames/s", "MB/s");
+    for (const UploadCase& upload : cases) {
+        for (GuestPixelFormat format : formats) {
+            GuestFramebuffer framebuffer(renderer);
+            framebuffer.SetSoftwareScaling(upload.softwareScaling);
+            TestPattern pattern(upload.width, upload.height, format);
+            const GuestFrame& frame = pattern.Render(0);
+            framebuffer.Upload(frame);
+
+            // Drawing into an area twice the frame size asks the next upload for 2x
+            SDL_Rect area = {0, 0, upload.width * 2, upload.height * 2};
+            framebuffer.Draw(area);
+            framebuffer.Upload(frame);
+            uint64_t bytesBefore = framebuffer.GetUploadedBytes();
+
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < frames; ++i) {
+                framebuffer.Upload(frame);
+            }
+            double seconds = SecondsSince(start);
+            double bytes = static_cast<double>(framebuffer.GetUploadedBytes() - bytesBefore);
+
+            char size[32];
+            std::snprintf(size, sizeof(size), "%dx%d", upload.width, upload.height);
+            std::printf("%10s %10s %5dx %12.0f %12.0f\n", size, PixelConvert::GetFormatName(format),
+                        framebuffer.GetSoftwareScale(), seconds > 0.0 ? frames / seconds : 0.0,
+                        seconds > 0.0 ? bytes / seconds / 1e6 : 0.0);
+        }
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
@@ -1,17 +1,74 @@
 #include "ConfigManager.h"
+#include "AtomicFile.h"
+#include "Profiler.h"
 #include <fstream>
 #include <iostream>
 
-ConfigManager::ConfigManager() {
+namespace {
+
+// One lookup per known key, typed by the field it fills
+void ReadSetting(const json& config, const char* key, int& value) {
+    auto it = config.find(key);
+    if (it != config.end() && it->is_number_integer()) {
+        value = it->get<int>();
+    }
+}
+
+void ReadSetting(const json& config, const char* key, bool& value) {
+    auto it = config.find(key);
+    if (it != config.end() && it->is_boolean()) {
+        value = it->get<bool>();
+    }
+}
+
+void ReadSetting(const json& config, const char* key, std::string& value) {
+    auto it = config.find(key);
+    if (it != config.end() && it->is_string()) {
+        value = it->get<std::string>();
+    }
+}
+
+bool HasKind(const json& value, SettingKind kind) {
+    switch (kind) {
+        case SettingKind::Int: return value.is_number_integer();
+        case SettingKind::Bool: return value.is_boolean();
+        case SettingKind::String: return value.is_string();
+    }
+    return false;
+}
+
+} // namespace
+
+ConfigManager::ConfigManager()
+    : m_changeSerial(0)
+    , m_savedSerial(0)
+    , m_flushRequested(false)
+    , m_stopping(false)
+    , m_lastWriteOk(true)
+    , m_writeCount(0)
+{
     m_configPath = "config.json";
     CreateDefaultConfig();
 }
 
 ConfigManager::~ConfigManager() {
+    // The writer saves whatever is still pending before it exits
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
 }
 
 bool ConfigManager::LoadConfig(const std::string& filepath) {
-    m_configPath = filepath;
+    PROFILE_ZONE("ConfigManager::LoadConfig");
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_configPath = filepath;
+    }
     
     std::ifstream file(filepath);
     if (!file.is_open()) {
@@ -21,8 +78,19 @@ bool ConfigManager::LoadConfig(const std::string& filepath) {
     }
     
     try {
-        file >> m_config;
+        json config;
+        file >> config;
         file.close();
+        if (!config.is_object()) {
+            std::cerr << "Error loading config: " << filepath << " is not a JSON object" << std::endl;
+            CreateDefaultConfig();
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_config = std::move(config);
+        }
+        ParseSettings();
         return true;
     }
     catch (const std::exception& e) {
@@ -33,74 +101,248 @@ bool ConfigManager::LoadConfig(const std::string& filepath) {
 }
 
 bool ConfigManager::SaveConfig(const std::string& filepath) {
+    PROFILE_ZONE("ConfigManager::SaveConfig");
     std::string savePath = filepath.empty() ? m_configPath : filepath;
     
-    std::ofstream file(savePath);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not save config to " << savePath << std::endl;
+    std::string contents;
+    try {
+        contents = m_config.dump();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error saving config: " << e.what() << std::endl;
         return false;
     }
-    
+    return WriteConfigFile(savePath, contents);
+}
+
+bool ConfigManager::Flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t target = m_changeSerial;
+    if (m_savedSerial == target) {
+        return m_lastWriteOk;
+    }
+    m_flushRequested = true;
+    m_wake.notify_one();
+    m_saved.wait(lock, [this, target] { return m_savedSerial >= target; });
+    m_flushRequested = false;
+    return m_lastWriteOk;
+}
+
+uint64_t ConfigManager::GetWriteCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_writeCount;
+}
+
+std::string ConfigManager::GetSnapshot() const {
+    return m_config.dump();
+}
+
+bool ConfigManager::LoadSnapshot(const std::string& snapshot) {
     try {
-        file << m_config.dump(4); // Pretty print with 4 spaces
-        file.close();
+        json config = json::parse(snapshot);
+        if (!config.is_object()) {
+            std::cerr << "Error loading config snapshot: not an object" << std::endl;
+            return false;
+        }
+        LoadDocument(config);
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error saving config: " << e.what() << std::endl;
+        std::cerr << "Error loading config snapshot: " << e.what() << std::endl;
         return false;
     }
 }
 
+void ConfigManager::LoadDocument(const json& config) {
+    PROFILE_ZONE("ConfigManager::LoadDocument");
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_config = config;
+    }
+    ParseSettings();
+}
+
+bool ConfigManager::HasPendingChanges() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_changeSerial != m_savedSerial;
+}
+
 std::string ConfigManager::GetString(const std::string& key, const std::string& defaultValue) const {
-    if (m_config.contains(key) && m_config[key].is_string()) {
-        return m_config[key].get<std::string>();
+    auto it = m_config.find(key);
+    if (it != m_config.end() && it->is_string()) {
+        return it->get<std::string>();
     }
     return defaultValue;
 }
 
 int ConfigManager::GetInt(const std::string& key, int defaultValue) const {
-    if (m_config.contains(key) && m_config[key].is_number_integer()) {
-        return m_config[key].get<int>();
+    auto it = m_config.find(key);
+    if (it != m_config.end() && it->is_number_integer()) {
+        return it->get<int>();
     }
     return defaultValue;
 }
 
 float ConfigManager::GetFloat(const std::string& key, float defaultValue) const {
-    if (m_config.contains(key) && m_config[key].is_number_float()) {
-        return m_config[key].get<float>();
+    auto it = m_config.find(key);
+    if (it != m_config.end() && it->is_number_float()) {
+        return it->get<float>();
     }
     return defaultValue;
 }
 
 bool ConfigManager::GetBool(const std::string& key, bool defaultValue) const {
-    if (m_config.contains(key) && m_config[key].is_boolean()) {
-        return m_config[key].get<bool>();
+    auto it = m_config.find(key);
+    if (it != m_config.end() && it->is_boolean()) {
+        return it->get<bool>();
     }
     return defaultValue;
 }
 
 void ConfigManager::SetString(const std::string& key, const std::string& value) {
-    m_config[key] = value;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_config[key] = value;
+        MarkChanged();
+    }
+    ParseSetting(key);
 }
 
 void ConfigManager::SetInt(const std::string& key, int value) {
-    m_config[key] = value;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_config[key] = value;
+        MarkChanged();
+    }
+    ParseSetting(key);
 }
 
 void ConfigManager::SetFloat(const std::string& key, float value) {
-    m_config[key] = value;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_config[key] = value;
+        MarkChanged();
+    }
+    ParseSetting(key);
 }
 
 void ConfigManager::SetBool(const std::string& key, bool value) {
-    m_config[key] = value;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_config[key] = value;
+        MarkChanged();
+    }
+    ParseSetting(key);
+}
+
+const SettingKey* ConfigManager::FindSettingKey(const std::string& key) {
+    for (const SettingKey& setting : kSettingKeys) {
+        if (key == setting.key) {
+            return &setting;
+        }
+    }
+    return nullptr;
 }
 
 void ConfigManager::CreateDefaultConfig() {
-    m_config = json::object();
-    m_config["window_width"] = 1280;
-    m_config["window_height"] = 720;
-    m_config["fullscreen"] = false;
-    m_config["vsync"] = true;
-    m_config["target_fps"] = 60;
+    m_settings = Settings();
+    json config = json::object();
+#define EMULATOR_SETTING_DEFAULT(kind, field, key, value) config[key] = m_settings.field;
+    EMULATOR_SETTINGS(EMULATOR_SETTING_DEFAULT)
+#undef EMULATOR_SETTING_DEFAULT
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = std::move(config);
+}
+
+Settings ConfigManager::ReadSettings(const json& config) {
+    // A missing or mistyped key keeps its default
+    Settings settings;
+#define EMULATOR_SETTING_READ(kind, field, key, value) ReadSetting(config, key, settings.field);
+    EMULATOR_SETTINGS(EMULATOR_SETTING_READ)
+#undef EMULATOR_SETTING_READ
+    return settings;
+}
+
+void ConfigManager::ParseSettings() {
+    m_settings = ReadSettings(m_config);
+
+    // Unknown keys stay in the file, but a typo should not pass silently
+    for (auto it = m_config.begin(); it != m_config.end(); ++it) {
+        const SettingKey* setting = FindSettingKey(it.key());
+        if (!setting) {
+            std::cerr << "Warning: Unknown config setting '" << it.key() << "' is ignored" << std::endl;
+        }
+        else if (!HasKind(it.value(), setting->kind)) {
+            std::cerr << "Warning: Config setting '" << it.key() << "' has the wrong type, using its default" << std::endl;
+        }
+    }
+}
+
+void ConfigManager::ParseSetting(const std::string& key) {
+    const Settings defaults;
+#define EMULATOR_SETTING_READ_ONE(kind, field, name, value) \
+    if (key == name) { \
+        m_settings.field = defaults.field; \
+        ReadSetting(m_config, name, m_settings.field); \
+        return; \
+    }
+    EMULATOR_SETTINGS(EMULATOR_SETTING_READ_ONE)
+#undef EMULATOR_SETTING_READ_ONE
+}
+
+void ConfigManager::MarkChanged() {
+    ++m_changeSerial;
+    m_lastChange = std::chrono::steady_clock::now();
+    if (!m_writer.joinable()) {
+        m_writer = std::thread(&ConfigManager::WriterLoop, this);
+    }
+    m_wake.notify_one();
+}
+
+void ConfigManager::WriterLoop() {
+    Profiler::SetThreadName("config writer");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_wake.wait(lock, [this] { return m_stopping || m_changeSerial != m_savedSerial; });
+        if (m_changeSerial == m_savedSerial) {
+            return;
+        }
+
+        // Let a burst of changes settle, unless someone is waiting for them
+        while (!m_stopping && !m_flushRequested && std::chrono::steady_clock::now() < m_lastChange + kSaveDelay) {
+            m_wake.wait_until(lock, m_lastChange + kSaveDelay);
+        }
+
+        // Serialized under the lock, so the file holds one consistent state
+        uint64_t serial = m_changeSerial;
+        std::string path = m_configPath;
+        std::string contents;
+        bool ok = true;
+        try {
+            contents = m_config.dump();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error saving config: " << e.what() << std::endl;
+            ok = false;
+        }
+
+        lock.unlock();
+        ok = ok && WriteConfigFile(path, contents);
+        lock.lock();
+
+        m_savedSerial = serial;
+        m_lastWriteOk = ok;
+        ++m_writeCount;
+        m_saved.notify_all();
+    }
+}
+
+bool ConfigManager::WriteConfigFile(const std::string& filepath, const std::string& contents) {
+    PROFILE_ZONE("ConfigManager::WriteConfigFile");
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    if (!WriteFileAtomic(filepath, contents)) {
+        std::cerr << "Error: Could not save config to " << filepath << std::endl;
+        return false;
+    }
+    return true;
 }
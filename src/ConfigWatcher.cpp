@@ -0,0 +1,314 @@
+#include "ConfigWatcher.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+#endif
+
+namespace fs = std::filesystem;
+
+ConfigWatcher::ConfigWatcher(const std::string& filepath, const json& document)
+    : m_path(filepath)
+    , m_stopping(false)
+#ifdef _WIN32
+    , m_notifier(nullptr)
+    , m_wakeEvent(nullptr)
+#else
+    , m_notifier(-1)
+    , m_wakePipe{-1, -1}
+#endif
+    , m_current(nullptr)
+    , m_generation(0)
+    , m_readerCount(0)
+{
+    for (std::atomic<uint64_t>& generation : m_readerGenerations) {
+        generation.store(0);
+    }
+
+    auto snapshot = std::make_unique<ConfigSnapshot>();
+    snapshot->generation = 1;
+    snapshot->document = document;
+    snapshot->settings = ConfigManager::ReadSettings(document);
+    Publish(std::move(snapshot));
+    m_stamp = ReadStamp();
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    Stop();
+}
+
+void ConfigWatcher::Start() {
+    if (m_thread.joinable()) {
+        return;
+    }
+    m_stopping = false;
+#ifdef _WIN32
+    m_wakeEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    bool canWake = m_wakeEvent != nullptr;
+#else
+    bool canWake = ::pipe(m_wakePipe) == 0;
+    if (!canWake) {
+        m_wakePipe[0] = m_wakePipe[1] = -1;
+    }
+#endif
+    if (!canWake) {
+        std::cerr << "Error: Could not start the config watcher; edits apply on restart" << std::endl;
+        return;
+    }
+    if (!OpenNotifier()) {
+        std::cout << "Config watcher: no change notifications, polling " << m_path.string() << std::endl;
+    }
+    m_thread = std::thread(&ConfigWatcher::ThreadLoop, this);
+}
+
+void ConfigWatcher::Stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    m_stopping = true;
+#ifdef _WIN32
+    if (m_wakeEvent) {
+        SetEvent(m_wakeEvent);
+    }
+#else
+    if (m_wakePipe[1] >= 0) {
+        char byte = 0;
+        while (::write(m_wakePipe[1], &byte, 1) < 0 && errno == EINTR) {
+        }
+    }
+#endif
+    m_thread.join();
+
+    CloseNotifier();
+#ifdef _WIN32
+    if (m_wakeEvent) {
+        CloseHandle(m_wakeEvent);
+        m_wakeEvent = nullptr;
+    }
+#else
+    for (int& fd : m_wakePipe) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+#endif
+}
+
+int ConfigWatcher::RegisterReader() {
+    int reader = m_readerCount.fetch_add(1);
+    if (reader >= kMaxReaders) {
+        m_readerCount.fetch_sub(1);
+        return -1;
+    }
+    return reader;
+}
+
+const ConfigSnapshot& ConfigWatcher::Acquire(int reader) {
+    // The snapshot can't be freed between these two lines: that takes this
+    // reader's slot being past its generation, and only this store moves it
+    const ConfigSnapshot* snapshot = m_current.load();
+    m_readerGenerations[reader].store(snapshot->generation);
+    return *snapshot;
+}
+
+void ConfigWatcher::ThreadLoop() {
+    Profiler::SetThreadName("config watcher");
+    while (WaitForChange()) {
+        Reload();
+        Reclaim();
+    }
+}
+
+#ifdef _WIN32
+
+bool ConfigWatcher::OpenNotifier() {
+    fs::path directory = m_path.parent_path();
+    std::wstring wideDirectory = directory.empty() ? L"." : directory.wstring();
+    HANDLE notifier = FindFirstChangeNotificationW(wideDirectory.c_str(), FALSE,
+                                                   FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE |
+                                                   FILE_NOTIFY_CHANGE_LAST_WRITE);
+    m_notifier = notifier == INVALID_HANDLE_VALUE ? nullptr : notifier;
+    return m_notifier != nullptr;
+}
+
+void ConfigWatcher::CloseNotifier() {
+    if (m_notifier) {
+        FindCloseChangeNotification(m_notifier);
+        m_notifier = nullptr;
+    }
+}
+
+bool ConfigWatcher::WaitForChange() {
+    HANDLE handles[2] = { m_wakeEvent, m_notifier };
+    DWORD count = m_notifier ? 2 : 1;
+    DWORD timeout = m_notifier ? INFINITE : static_cast<DWORD>(kPollInterval.count());
+    DWORD result = WaitForMultipleObjects(count, handles, FALSE, timeout);
+    if (m_stopping || result == WAIT_FAILED) {
+        return false;
+    }
+    // The notification covers the whole directory; Reload tells whether it was the config
+    if (result == WAIT_OBJECT_0 + 1) {
+        FindNextChangeNotification(m_notifier);
+    }
+    return true;
+}
+
+#else
+
+bool ConfigWatcher::OpenNotifier() {
+#ifdef __linux__
+    m_notifier = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_notifier < 0) {
+        return false;
+    }
+    fs::path directory = m_path.parent_path();
+    if (inotify_add_watch(m_notifier, directory.empty() ? "." : directory.c_str(),
+                          IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) < 0) {
+        CloseNotifier();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ConfigWatcher::CloseNotifier() {
+    if (m_notifier >= 0) {
+        ::close(m_notifier);
+        m_notifier = -1;
+    }
+}
+
+bool ConfigWatcher::WaitForChange() {
+    pollfd fds[2] = {
+        { m_wakePipe[0], POLLIN, 0 },
+        { m_notifier, POLLIN, 0 },
+    };
+    int timeout = m_notifier >= 0 ? -1 : static_cast<int>(kPollInterval.count());
+    while (::poll(fds, m_notifier >= 0 ? 2 : 1, timeout) < 0 && errno == EINTR) {
+    }
+    if (m_stopping) {
+        return false;
+    }
+    // Only the fact that something in the directory changed matters;
+    // Reload tells whether it was the config
+    if (m_notifier >= 0 && (fds[1].revents & POLLIN)) {
+        alignas(8) char events[4096];
+        while (::read(m_notifier, events, sizeof(events)) > 0) {
+        }
+    }
+    return true;
+}
+
+#endif
+
+void ConfigWatcher::Reload() {
+    FileStamp stamp = ReadStamp();
+    if (stamp == m_stamp) {
+        return;
+    }
+
+    // Editors may save in several steps; read once the file has stopped changing
+    do {
+        m_stamp = stamp;
+        std::this_thread::sleep_for(kSettleDelay);
+        stamp = ReadStamp();
+    } while (stamp != m_stamp && !m_stopping);
+
+    // Deleted (or between a delete and a rename): keep the current settings
+    if (!m_stamp.exists) {
+        return;
+    }
+
+    std::ifstream file(m_path);
+    if (!file.is_open()) {
+        return;
+    }
+    PROFILE_ZONE("ConfigWatcher::Reload");
+    json document;
+    try {
+        file >> document;
+    }
+    catch (const std::exception& e) {
+        // Most likely a half-finished edit; the next save is picked up again
+        std::cerr << "Error reloading config: " << e.what() << std::endl;
+        return;
+    }
+    if (!document.is_object()) {
+        std::cerr << "Error reloading config: " << m_path.string() << " is not a JSON object" << std::endl;
+        return;
+    }
+
+    // Touched or re-saved without a change
+    const ConfigSnapshot* current = m_current.load();
+    if (document == current->document) {
+        return;
+    }
+
+    auto snapshot = std::make_unique<ConfigSnapshot>();
+    snapshot->generation = current->generation + 1;
+    snapshot->settings = ConfigManager::ReadSettings(document);
+    snapshot->document = std::move(document);
+    Publish(std::move(snapshot));
+    std::cout << "Config reloaded: " << m_path.string() << " (generation " << m_generation.load() << ")" << std::endl;
+}
+
+void ConfigWatcher::Publish(std::unique_ptr<ConfigSnapshot> snapshot) {
+    const ConfigSnapshot* published = snapshot.get();
+    m_snapshots.push_back(std::move(snapshot));
+    m_current.store(published);
+    m_generation.store(published->generation);
+    Reclaim();
+}
+
+void ConfigWatcher::Reclaim() {
+    // Oldest generation a reader may still be using
+    uint64_t oldest = m_generation.load();
+    int readers = std::min(m_readerCount.load(), kMaxReaders);
+    for (int i = 0; i < readers; ++i) {
+        oldest = std::min(oldest, m_readerGenerations[i].load());
+    }
+    const ConfigSnapshot* current = m_current.load();
+    m_snapshots.erase(std::remove_if(m_snapshots.begin(), m_snapshots.end(),
+                                     [&](const std::unique_ptr<ConfigSnapshot>& snapshot) {
+                                         return snapshot.get() != current && snapshot->generation < oldest;
+                                     }),
+                      m_snapshots.end());
+}
+
+ConfigWatcher::FileStamp ConfigWatcher::ReadStamp() const {
+    FileStamp stamp;
+    std::error_code ec;
+    auto modified = fs::last_write_time(m_path, ec);
+    if (ec) {
+        return stamp;
+    }
+    uint64_t size = fs::file_size(m_path, ec);
+    if (ec) {
+        return stamp;
+    }
+    stamp.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+    stamp.size = size;
+    stamp.exists = true;
+    return stamp;
+}
@@ -0,0 +1,128 @@
+#include "DrawList.h"
+#include "TextRenderer.h"
+#include <algorithm>
+
+DrawList::DrawList(TextRenderer& text)
+    : m_text(text)
+    , m_clipped(false)
+    , m_clip{0.0f, 0.0f, 0.0f, 0.0f}
+{
+}
+
+DrawList::~DrawList() {
+}
+
+void DrawList::Clear() {
+    // Keeps the capacity: a rebuilt widget reuses its old buffers
+    m_vertices.clear();
+    m_batches.clear();
+}
+
+void DrawList::AddRect(int x, int y, int w, int h, SDL_Color color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    size_t first = m_vertices.size();
+    SDL_FRect rect = {static_cast<float>(x), static_cast<float>(y), static_cast<float>(w), static_cast<float>(h)};
+    m_text.AppendSolid(rect, color, m_vertices);
+    ClipQuads(first);
+    CloseBatch(m_text.GetAtlas(), first);
+}
+
+void DrawList::AddRectOutline(int x, int y, int w, int h, SDL_Color color) {
+    AddRect(x, y, w, 1, color);
+    AddRect(x, y + h - 1, w, 1, color);
+    AddRect(x, y + 1, 1, h - 2, color);
+    AddRect(x + w - 1, y + 1, 1, h - 2, color);
+}
+
+void DrawList::AddText(std::string_view text, int x, int y, SDL_Color color) {
+    size_t first = m_vertices.size();
+    m_text.AppendText(text, x, y, color, m_vertices);
+    ClipQuads(first);
+    CloseBatch(m_text.GetAtlas(), first);
+}
+
+void DrawList::SetClipRect(const SDL_Rect* clip) {
+    m_clipped = clip != nullptr;
+    if (clip) {
+        m_clip = {static_cast<float>(clip->x), static_cast<float>(clip->y),
+                  static_cast<float>(clip->w), static_cast<float>(clip->h)};
+    }
+}
+
+void DrawList::ClipQuads(size_t firstVertex) {
+    if (!m_clipped) {
+        return;
+    }
+
+    // Quads are axis aligned (top-left, top-right, bottom-left, bottom-right),
+    // so clipping moves edges and interpolates the texture coordinates to match
+    float clipRight = m_clip.x + m_clip.w;
+    float clipBottom = m_clip.y + m_clip.h;
+    size_t kept = firstVertex;
+    for (size_t i = firstVertex; i < m_vertices.size(); i += 4) {
+        SDL_Vertex* quad = &m_vertices[i];
+        float x0 = quad[0].position.x;
+        float y0 = quad[0].position.y;
+        float x1 = quad[3].position.x;
+        float y1 = quad[3].position.y;
+        float cx0 = std::max(x0, m_clip.x);
+        float cy0 = std::max(y0, m_clip.y);
+        float cx1 = std::min(x1, clipRight);
+        float cy1 = std::min(y1, clipBottom);
+        if (cx0 >= cx1 || cy0 >= cy1) {
+            continue;
+        }
+
+        float u0 = quad[0].tex_coord.x;
+        float v0 = quad[0].tex_coord.y;
+        float du = (quad[3].tex_coord.x - u0) / (x1 - x0);
+        float dv = (quad[3].tex_coord.y - v0) / (y1 - y0);
+        float cu0 = u0 + (cx0 - x0) * du;
+        float cu1 = u0 + (cx1 - x0) * du;
+        float cv0 = v0 + (cy0 - y0) * dv;
+        float cv1 = v0 + (cy1 - y0) * dv;
+
+        SDL_Color color = quad[0].color;
+        m_vertices[kept++] = {{cx0, cy0}, color, {cu0, cv0}};
+        m_vertices[kept++] = {{cx1, cy0}, color, {cu1, cv0}};
+        m_vertices[kept++] = {{cx0, cy1}, color, {cu0, cv1}};
+        m_vertices[kept++] = {{cx1, cy1}, color, {cu1, cv1}};
+    }
+    m_vertices.resize(kept);
+}
+
+void DrawList::CloseBatch(SDL_Texture* texture, size_t firstVertex) {
+    size_t added = m_vertices.size() - firstVertex;
+    if (added == 0) {
+        return;
+    }
+
+    if (!m_batches.empty() && m_batches.back().texture == texture) {
+        m_batches.back().vertexCount += added;
+    } else {
+        m_batches.push_back({texture, firstVertex, added});
+    }
+
+    // Two triangles per quad; the pattern only depends on a quad's position in
+    // its batch, so it is extended for the largest batch and shared by all
+    size_t quads = m_batches.back().vertexCount / 4;
+    for (int quad = static_cast<int>(m_indices.size() / 6); static_cast<size_t>(quad) < quads; ++quad) {
+        int base = quad * 4;
+        m_indices.insert(m_indices.end(), {base, base + 1, base + 2, base + 2, base + 1, base + 3});
+    }
+}
+
+int DrawList::Submit(SDL_Renderer* renderer) const {
+    int drawCalls = 0;
+    for (const Batch& batch : m_batches) {
+        if (!batch.texture) {
+            continue;
+        }
+        SDL_RenderGeometry(renderer, batch.texture, &m_vertices[batch.firstVertex], static_cast<int>(batch.vertexCount),
+                           m_indices.data(), static_cast<int>(batch.vertexCount / 4 * 6));
+        ++drawCalls;
+    }
+    return drawCalls;
+}
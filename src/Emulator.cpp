@@ -1,21 +1,63 @@
 #include "Emulator.h"
+#include "APKCatalog.h"
+#include "AllocationCounter.h"
+#include "Profiler.h"
+#include "StartupTrace.h"
 #include <iostream>
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// FNV-1a over 64-bit words: any single changed word changes the result, which
+// is all a frame regression check needs, at memory speed
+uint64_t HashBytes(const uint8_t* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// What the APK list shows until the APK manager has come up
+const std::vector<std::string_view> kNoAPKs;
+
+} // namespace
 
 Emulator::Emulator()
     : m_window(nullptr)
     , m_renderer(nullptr)
     , m_running(false)
-    , m_fps(0.0f)
     , m_frameTime(0.0f)
-    , m_frameCount(0)
+    , m_telemetry(std::make_unique<FrameTelemetry>())
+    , m_frameArena(std::make_unique<FrameArena>())
+    , m_frameIndex(0)
+    , m_inputLatency(std::make_unique<InputLatencyTracker>())
+    , m_guestInputsPushed(0)
+    , m_recordedTick(0)
+    , m_deterministic(false)
+    , m_hashFrames(false)
+    , m_displayHz(0.0)
+    , m_configReader(-1)
+    , m_configGeneration(0)
+    , m_guestTick(~uint64_t(0))
+    , m_firstFrameMicros(0)
+    , m_catalogReady(false)
+    , m_startupTraceWritten(false)
     , m_showDebugOverlay(false)
     , m_showAboutScreen(false)
     , m_showMainMenu(true)
+    , m_showTestPattern(false)
 {
     m_lastFrameTime = std::chrono::high_resolution_clock::now();
-    m_fpsUpdateTime = m_lastFrameTime;
 }
 
 Emulator::~Emulator() {
@@ -23,23 +65,58 @@ Emulator::~Emulator() {
 }
 
 bool Emulator::Initialize() {
-    // Initialize SDL
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
+    // Per-monitor DPI awareness, so Windows hands us real pixels instead of
+    // bitmap-scaling the window on high-DPI displays
+#ifdef SDL_HINT_WINDOWS_DPI_AWARENESS
+    SDL_SetHint(SDL_HINT_WINDOWS_DPI_AWARENESS, "permonitorv2");
+#endif
+    
+    // Each step below is one phase of the startup trace
+    uint64_t phaseBegin = StartupTrace::Now();
+    auto endPhase = [&phaseBegin](const char* name) {
+        uint64_t now = StartupTrace::Now();
+        StartupTrace::AddPhase(name, phaseBegin, now);
+        phaseBegin = now;
+    };
+    
+    // The APK manager (thread pool, store manifest, index, loose APKs) comes up
+    // on a worker while SDL creates the window and renderer. The first frames
+    // show an empty list; Update adopts the manager once it is ready.
+    m_apkManagerLoad = std::async(std::launch::async, [] {
+        StartupTrace::SetThreadName("APK loader");
+        Profiler::SetThreadName("APK loader");
+        StartupPhase phase("APK manager");
+        auto apkManager = std::make_unique<APKManager>();
+        apkManager->SetInstallDirectory("apks");
+        return apkManager;
+    });
+    
+    // Initialize SDL. Video only: nothing plays sound yet, and opening the
+    // audio devices is a noticeable part of startup on Windows. Whatever first
+    // needs audio starts it with SDL_InitSubSystem(SDL_INIT_AUDIO).
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
         return false;
     }
+    endPhase("SDL_Init");
     
     // Initialize config manager
     m_configManager = std::make_unique<ConfigManager>();
     m_configManager->LoadConfig();
     
+    // A replay runs with the configuration it was recorded with
+    if (m_inputReplay && !m_configManager->LoadSnapshot(m_inputReplay->GetConfig())) {
+        return false;
+    }
+    endPhase("Load config");
+    
     // Get window settings from config
     int width = m_configManager->GetWindowWidth();
     int height = m_configManager->GetWindowHeight();
     bool fullscreen = m_configManager->GetFullscreen();
     
     // Create window
-    Uint32 windowFlags = SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE;
+    Uint32 windowFlags = SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI;
     if (fullscreen) {
         windowFlags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
     }
@@ -57,27 +134,62 @@ bool Emulator::Initialize() {
         std::cerr << "Window creation failed: " << SDL_GetError() << std::endl;
         return false;
     }
+    endPhase("Create window");
+    
+    PacingMode pacing = GetConfiguredPacing();
     
     // Create renderer (GPU accelerated)
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+    if (pacing == PacingMode::VSync) {
+        rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+    }
     m_renderer = SDL_CreateRenderer(
         m_window,
         -1,
-        SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
+        rendererFlags
     );
     
+    // No GPU renderer (remote desktop, dummy video driver): fall back to software
+    if (!m_renderer) {
+        std::cerr << "Accelerated renderer unavailable (" << SDL_GetError() << "), using software" << std::endl;
+        m_renderer = SDL_CreateRenderer(m_window, -1, SDL_RENDERER_SOFTWARE);
+    }
+    
     if (!m_renderer) {
         std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
         return false;
     }
     
+    SDL_DisplayMode displayMode;
+    if (SDL_GetWindowDisplayMode(m_window, &displayMode) == 0 && displayMode.refresh_rate > 0) {
+        m_displayHz = displayMode.refresh_rate;
+    }
+    m_framePacer = std::make_unique<FramePacer>();
+    m_framePacer->Configure(pacing, m_configManager->GetTargetFPS(), m_displayHz);
+    std::cout << "Frame pacing: " << FramePacer::GetModeName(m_framePacer->GetMode()) << std::endl;
+    endPhase("Create renderer");
+    
     // Initialize components
     m_keyMapper = std::make_unique<KeyMapper>();
     m_keyMapper->SetDefaultMappings();
     
-    m_apkManager = std::make_unique<APKManager>();
-    m_apkManager->SetInstallDirectory("apks");
+    m_simulation = std::make_unique<Simulation>(m_configManager->GetTickRate());
     
     m_ui = std::make_unique<UI>(m_renderer);
+    UpdateOutputSize();
+    endPhase("Create UI");
+    
+    // Guest display. The software renderer's scaled copies are slow, so there
+    // the integer upscale happens during the upload instead.
+    SDL_RendererInfo rendererInfo;
+    bool softwareRenderer = SDL_GetRendererInfo(m_renderer, &rendererInfo) == 0 &&
+                            (rendererInfo.flags & SDL_RENDERER_SOFTWARE) != 0;
+    m_guestFramebuffer = std::make_unique<GuestFramebuffer>(m_renderer);
+    m_guestFramebuffer->SetScaleMode(GuestFramebuffer::ParseScaleMode(m_configManager->GetGuestScaling(), GuestScaleMode::Integer));
+    m_guestFramebuffer->SetLinearFilter(m_configManager->GetGuestFilter() == "linear");
+    m_guestFramebuffer->SetSoftwareScaling(softwareRenderer);
+    std::cout << "Pixel conversion: " << PixelConvert::GetSimdLevelName(PixelConvert::GetSimdLevel()) << std::endl;
+    endPhase("Create guest display");
     
     m_running = true;
     
@@ -86,28 +198,401 @@ bool Emulator::Initialize() {
 }
 
 void Emulator::Run() {
+    // Edits to the config file apply while the session runs; both this thread
+    // and the simulation's read the newest settings without locking
+    m_configWatcher = std::make_unique<ConfigWatcher>(m_configManager->GetConfigPath(), m_configManager->GetDocument());
+    m_configReader = m_configWatcher->RegisterReader();
+    m_configGeneration = m_configWatcher->GetGeneration();
+    m_simulation->SetConfigSource(m_configWatcher.get());
+    m_configWatcher->Start();
+    
+    // Emulation ticks on its own thread from here on; this loop only handles
+    // input, UI housekeeping and rendering
+    m_simulation->Start();
+    
     while (m_running) {
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        auto deltaTime = std::chrono::duration<float>(currentTime - m_lastFrameTime).count();
-        m_lastFrameTime = currentTime;
-        
-        // Frame pacing - limit to target FPS
-        if (deltaTime < m_targetFrameTime) {
-            float sleepTime = (m_targetFrameTime - deltaTime) * 1000.0f;
-            SDL_Delay(static_cast<Uint32>(sleepTime));
-            deltaTime = m_targetFrameTime;
-        }
-        
-        m_frameTime = deltaTime;
-        UpdateFPS(deltaTime);
-        
-        ProcessEvents();
-        Update(deltaTime);
-        Render();
+        RunFrame();
+    }
+    
+    m_simulation->Stop();
+    m_configWatcher->Stop();
+}
+
+void Emulator::RunFrame() {
+    // One zone per iteration of Run's loop; Run itself spans the whole session
+    PROFILE_ZONE("Frame");
+    uint64_t firstFrameBegin = m_firstFrameMicros == 0 ? StartupTrace::Now() : 0;
+    
+    // Real time since the previous frame started, including the pacing sleep
+    auto currentTime = std::chrono::high_resolution_clock::now();
+    auto deltaTime = std::chrono::duration<float>(currentTime - m_lastFrameTime).count();
+    m_lastFrameTime = currentTime;
+    
+    // Replays take the time step and tick count of the recorded frame; other
+    // deterministic runs advance exactly one tick per frame, whatever the wall clock says
+    if (m_inputReplay) {
+        if (!m_inputReplay->NextFrame()) {
+            m_running = false;
+            return;
+        }
+        const RecordedFrame& frame = m_inputReplay->GetFrame();
+        if (frame.viewFlags >= 0) {
+            SetViewFlags(static_cast<uint8_t>(frame.viewFlags));
+        }
+        deltaTime = frame.deltaMicros / 1000000.0f;
+        m_simulation->Advance(static_cast<int>(frame.ticks));
+    } else if (m_deterministic) {
+        deltaTime = static_cast<float>(m_simulation->GetTickSeconds());
+        m_simulation->Advance(1);
+    }
+    
+    // A recording starts from the view state of its first frame
+    if (m_inputRecorder && m_inputRecorder->GetFrameCount() == 0) {
+        m_inputRecorder->RecordView(GetViewFlags());
+    }
+    
+    m_frameTime = deltaTime;
+    
+    // Everything formatted for this frame lives in the arena until here
+    m_frameArena->Reset();
+    
+    // Scripted input lands in SDL's queue just ahead of this frame's pump
+    if (m_inputScript) {
+        m_inputScript->Inject(m_frameIndex);
+    }
+    ++m_frameIndex;
+    
+    // Per-phase timings feed the percentile telemetry shown in the overlay;
+    // pending key presses are stamped at the same phase boundaries
+    m_telemetry->BeginFrame();
+    ProcessEvents();
+    m_telemetry->EndPhase(FramePhase::Events);
+    Update(deltaTime);
+    m_telemetry->EndPhase(FramePhase::Update);
+    m_inputLatency->OnUpdateDone(std::chrono::steady_clock::now());
+    Render();
+    m_telemetry->EndPhase(FramePhase::Render);
+    m_inputLatency->OnRenderDone(std::chrono::steady_clock::now(), m_renderState.inputEvents);
+    if (m_hashFrames) {
+        // Read back before present; counted in the present phase
+        HashFrame();
+    }
+    {
+        PROFILE_ZONE("Present");
+        SDL_RenderPresent(m_renderer);
+    }
+    m_telemetry->EndPhase(FramePhase::Present);
+    m_inputLatency->OnPresentDone(std::chrono::steady_clock::now());
+    
+    if (m_firstFrameMicros == 0) {
+        m_firstFrameMicros = StartupTrace::Now();
+        StartupTrace::AddPhase("First frame", firstFrameBegin, m_firstFrameMicros);
+        StartupTrace::AddMark("First frame presented");
+        std::printf("Time to first frame: %.1f ms\n", m_firstFrameMicros / 1000.0);
+        WriteStartupTrace();
+    }
+    
+    if (m_inputRecorder) {
+        m_inputRecorder->EndFrame(static_cast<uint32_t>(deltaTime * 1000000.0f + 0.5f),
+                                  static_cast<uint32_t>(m_renderState.tick - m_recordedTick));
+        m_recordedTick = m_renderState.tick;
+    }
+    
+    // Frame pacing - sleep, then spin, until the next frame's deadline
+    {
+        PROFILE_ZONE("WaitForNextFrame");
+        m_framePacer->WaitForNextFrame();
+    }
+    m_telemetry->EndPhase(FramePhase::Sleep);
+    m_telemetry->EndFrame();
+}
+
+int Emulator::RunAllocationCheck(int frames) {
+    if (!AllocationCounter::IsEnabled()) {
+        std::cerr << "Error: Allocation counting not built in (configure with -DEMULATOR_ALLOCATION_CHECK=ON)" << std::endl;
+        return 1;
+    }
+    
+    // Every overlay on, no pacing: the most text the frame path ever formats
+    m_showDebugOverlay = true;
+    m_showAboutScreen = true;
+    m_showMainMenu = true;
+    m_showTestPattern = true;
+    m_framePacer->Configure(PacingMode::Uncapped, 0.0, 0.0);
+    m_simulation->Start();
+    
+    // Warm-up frames may allocate (first-use caches, the APK scan landing)
+    const int warmupFrames = 60;
+    for (int i = 0; i < warmupFrames && m_running; ++i) {
+        RunFrame();
+    }
+    WaitForAPKScan();
+    RunFrame();
+    
+    uint64_t before = AllocationCounter::GetCount();
+    for (int i = 0; i < frames && m_running; ++i) {
+        RunFrame();
+    }
+    uint64_t allocations = AllocationCounter::GetCount() - before;
+    m_simulation->Stop();
+    
+    std::cout << "Steady-state frames: " << frames << std::endl;
+    std::cout << "Heap allocations:    " << allocations << std::endl;
+    std::cout << "Frame arena peak:    " << m_frameArena->GetHighWater() << " / "
+              << m_frameArena->GetCapacity() << " bytes, " << m_frameArena->GetOverflowCount() << " overflows" << std::endl;
+    if (allocations != 0) {
+        std::cerr << "FAIL: the frame path allocated " << allocations << " times" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS" << std::endl;
+    return 0;
+}
+
+int Emulator::RunHeadless(int frames, bool hashFrames) {
+    // Everything the window shows, including the guest path; the debug overlay
+    // displays measurements, so it is left out of hashed runs
+    m_deterministic = hashFrames;
+    m_hashFrames = hashFrames;
+    m_showDebugOverlay = !hashFrames;
+    m_showTestPattern = true;
+    m_framePacer->Configure(PacingMode::Uncapped, 0.0, 0.0);
+    if (hashFrames) {
+        // The same catalog on every frame; the simulation is stepped by RunFrame
+        WaitForAPKScan();
+        m_frameHashes.reserve(static_cast<size_t>(frames));
+    } else {
+        m_simulation->Start();
+    }
+    
+    // Warm-up frames (texture creation, first-use caches) are not measured
+    const int warmupFrames = 60;
+    for (int i = 0; i < warmupFrames && m_running; ++i) {
+        RunFrame();
+    }
+    m_telemetry->Reset();
+    m_inputLatency->Reset();
+    m_frameHashes.clear();
+    
+    auto start = std::chrono::steady_clock::now();
+    int completed = 0;
+    for (; completed < frames && m_running; ++completed) {
+        RunFrame();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    m_simulation->Stop();
+    
+    PrintRunReport("Headless run", completed, seconds);
+    if (hashFrames && !ReportFrameHashes()) {
+        return 1;
+    }
+    return completed == frames ? 0 : 1;
+}
+
+bool Emulator::LoadReplay(const std::string& filepath) {
+    auto replay = std::make_unique<InputReplay>();
+    if (!replay->Load(filepath)) {
+        return false;
+    }
+    m_inputReplay = std::move(replay);
+    return true;
+}
+
+int Emulator::RunReplay(bool fast, bool hashFrames) {
+    if (!m_inputReplay) {
+        std::cerr << "No input recording loaded" << std::endl;
+        return 1;
+    }
+    
+    // The simulation is stepped by RunFrame as the recording says
+    m_deterministic = true;
+    m_hashFrames = hashFrames;
+    if (fast) {
+        m_framePacer->Configure(PacingMode::Uncapped, 0.0, 0.0);
+    }
+    WaitForAPKScan();
+    m_frameHashes.reserve(m_inputReplay->GetFrameCount());
+    
+    const UILayout& layout = m_ui->GetLayout();
+    if (layout.GetOutputWidth() != m_inputReplay->GetOutputWidth() ||
+        layout.GetOutputHeight() != m_inputReplay->GetOutputHeight()) {
+        std::cerr << "Warning: recorded at " << m_inputReplay->GetOutputWidth() << "x" << m_inputReplay->GetOutputHeight()
+                  << ", replaying at " << layout.GetOutputWidth() << "x" << layout.GetOutputHeight()
+                  << "; frame times and hashes are not comparable" << std::endl;
+    }
+    
+    // Statistics skip the first frames (texture creation, first-use caches)
+    // unless the recording is too short to spare them; hashes cover every frame
+    const size_t warmupFrames = m_inputReplay->GetFrameCount() > 120 ? 60 : 0;
+    auto start = std::chrono::steady_clock::now();
+    while (m_running && !m_inputReplay->IsFinished()) {
+        if (m_inputReplay->GetFramesPlayed() == warmupFrames) {
+            m_telemetry->Reset();
+            m_inputLatency->Reset();
+            start = std::chrono::steady_clock::now();
+        }
+        RunFrame();
     }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    // Closed before the warm-up was over: nothing was measured
+    size_t played = m_inputReplay->GetFramesPlayed();
+    size_t measured = played > warmupFrames ? played - warmupFrames : 0;
+    PrintRunReport(fast ? "Replay (fast)" : "Replay (real time)", static_cast<int>(measured), seconds);
+    if (hashFrames && !ReportFrameHashes()) {
+        return 1;
+    }
+    return played == m_inputReplay->GetFrameCount() ? 0 : 1;
+}
+
+void Emulator::PrintRunReport(const char* title, int frames, double seconds) {
+    SDL_RendererInfo info;
+    const char* rendererName = SDL_GetRendererInfo(m_renderer, &info) == 0 ? info.name : "unknown";
+    const UILayout& layout = m_ui->GetLayout();
+    std::printf("%s: %d frames at %dx%d, %s renderer on the %s video driver\n", title, frames,
+                layout.GetOutputWidth(), layout.GetOutputHeight(), rendererName, SDL_GetCurrentVideoDriver());
+    std::printf("Wall time: %.3f s (%.1f frames/s)\n", seconds, seconds > 0.0 ? frames / seconds : 0.0);
+    std::printf("%10s %10s %10s %10s %10s\n", "phase", "mean (ms)", "p50 (ms)", "p99 (ms)", "max (ms)");
+    auto printRow = [](const char* name, const LatencyHistogram& histogram) {
+        std::printf("%10s %10.3f %10.3f %10.3f %10.3f\n", name, histogram.GetMean() / 1000.0,
+                    histogram.GetPercentile(0.50) / 1000.0, histogram.GetPercentile(0.99) / 1000.0,
+                    histogram.GetMax() / 1000.0);
+    };
+    for (size_t phase = 0; phase < static_cast<size_t>(FramePhase::Count); ++phase) {
+        printRow(FrameTelemetry::GetPhaseName(static_cast<FramePhase>(phase)),
+                 m_telemetry->GetHistogram(static_cast<FramePhase>(phase)));
+    }
+    printRow("frame", m_telemetry->GetFrameHistogram());
+    
+    // Stages after the pump are timed on the steady clock; the queue time before
+    // it only has SDL's millisecond timestamps, so it is reported on its own
+    if (m_inputLatency->GetEventCount() > 0) {
+        std::printf("Input latency: %llu key presses presented (%llu lost in flight)\n",
+                    static_cast<unsigned long long>(m_inputLatency->GetEventCount()),
+                    static_cast<unsigned long long>(m_inputLatency->GetOverflowCount()));
+        std::printf("%10s %10s %10s %10s %10s\n", "pump to", "mean (ms)", "p50 (ms)", "p99 (ms)", "max (ms)");
+        for (size_t stage = static_cast<size_t>(LatencyStage::Update); stage < static_cast<size_t>(LatencyStage::Count); ++stage) {
+            printRow(InputLatencyTracker::GetStageName(static_cast<LatencyStage>(stage)),
+                     m_inputLatency->GetHistogram(static_cast<LatencyStage>(stage)));
+        }
+        std::printf("Before the pump (SDL event timestamps, 1 ms resolution):\n");
+        printRow(InputLatencyTracker::GetStageName(LatencyStage::Queue), m_inputLatency->GetHistogram(LatencyStage::Queue));
+    }
+    DumpTelemetry();
+}
+
+bool Emulator::ReportFrameHashes() {
+    // One hash over the per-frame hashes; frame_hashes.txt locates the first difference
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(m_frameHashes.data());
+    uint64_t runHash = HashBytes(bytes, m_frameHashes.size() * sizeof(uint64_t));
+    if (!WriteFrameHashes("frame_hashes.txt")) {
+        return false;
+    }
+    std::printf("Frame hash: %016llx (per-frame hashes in frame_hashes.txt)\n",
+                static_cast<unsigned long long>(runHash));
+    return true;
+}
+
+bool Emulator::StartRecording(const std::string& filepath) {
+    auto recorder = std::make_unique<InputRecorder>();
+    const UILayout& layout = m_ui->GetLayout();
+    if (!recorder->Begin(filepath, m_configManager->GetSnapshot(), layout.GetOutputWidth(), layout.GetOutputHeight())) {
+        return false;
+    }
+    m_inputRecorder = std::move(recorder);
+    m_recordedTick = m_renderState.tick;
+    std::cout << "Recording input to " << filepath << std::endl;
+    return true;
+}
+
+bool Emulator::LoadInputScript(const std::string& filepath) {
+    auto script = std::make_unique<InputScript>();
+    if (filepath.empty()) {
+        script->LoadDefault();
+    } else if (!script->Load(filepath)) {
+        return false;
+    }
+    m_inputScript = std::move(script);
+    return true;
+}
+
+void Emulator::SetStartupTracePath(const std::string& filepath) {
+    m_startupTracePath = filepath;
+}
+
+bool Emulator::AdoptAPKManager(bool wait) {
+    if (m_apkManager) {
+        return true;
+    }
+    if (!m_apkManagerLoad.valid() ||
+        (!wait && m_apkManagerLoad.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) {
+        return false;
+    }
+    m_apkManager = m_apkManagerLoad.get();
+    StartupTrace::AddMark("APK manager adopted");
+    
+    // The catalog fills in over the first frames instead of blocking startup
+    m_apkManager->SetScanCallback([this](const std::vector<APKInfo>& added, const APKScanProgress& progress) {
+        (void)added;
+        if (progress.finished) {
+            std::cout << "APK scan complete: " << progress.total << " installed" << std::endl;
+            if (!m_catalogReady) {
+                m_catalogReady = true;
+                StartupTrace::AddMark("APK catalog ready");
+                WriteStartupTrace();
+            }
+        }
+    });
+    return true;
+}
+
+void Emulator::WaitForAPKScan() {
+    AdoptAPKManager(true);
+    m_apkManager->WaitForScan();
+}
+
+void Emulator::WriteStartupTrace() {
+    // Startup ends with the first frame on screen and the catalog loaded, in either order
+    if (m_startupTracePath.empty() || m_startupTraceWritten || m_firstFrameMicros == 0 || !m_catalogReady) {
+        return;
+    }
+    m_startupTraceWritten = true;
+    if (StartupTrace::Write(m_startupTracePath)) {
+        std::cout << "Startup trace written to " << m_startupTracePath << std::endl;
+    }
+}
+
+void Emulator::HashFrame() {
+    const UILayout& layout = m_ui->GetLayout();
+    int width = layout.GetOutputWidth();
+    int height = layout.GetOutputHeight();
+    int pitch = width * 4;
+    size_t size = static_cast<size_t>(pitch) * static_cast<size_t>(height);
+    if (m_readback.size() < size) {
+        m_readback.resize(size);
+    }
+    
+    uint64_t hash = 0;
+    if (size > 0 && SDL_RenderReadPixels(m_renderer, nullptr, SDL_PIXELFORMAT_RGBA32, m_readback.data(), pitch) == 0) {
+        hash = HashBytes(m_readback.data(), size);
+    }
+    m_frameHashes.push_back(hash);
+}
+
+bool Emulator::WriteFrameHashes(const std::string& filepath) const {
+    std::FILE* file = std::fopen(filepath.c_str(), "w");
+    if (!file) {
+        std::cerr << "Failed to write " << filepath << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < m_frameHashes.size(); ++i) {
+        std::fprintf(file, "%zu %016llx\n", i, static_cast<unsigned long long>(m_frameHashes[i]));
+    }
+    std::fclose(file);
+    return true;
 }
 
 void Emulator::ProcessEvents() {
+    PROFILE_ZONE("ProcessEvents");
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         switch (event.type) {
@@ -116,99 +601,389 @@ void Emulator::ProcessEvents() {
                 break;
                 
             case SDL_KEYDOWN:
-                if (event.key.keysym.scancode == SDL_SCANCODE_ESCAPE) {
-                    if (m_showAboutScreen) {
-                        m_showAboutScreen = false;
-                    } else if (m_showMainMenu) {
-                        m_showMainMenu = false;
-                    } else {
-                        m_running = false;
-                    }
-                }
-                else if (event.key.keysym.scancode == SDL_SCANCODE_F1) {
-                    m_showDebugOverlay = !m_showDebugOverlay;
-                }
-                else if (event.key.keysym.scancode == SDL_SCANCODE_F2) {
-                    m_showAboutScreen = !m_showAboutScreen;
-                }
-                else if (event.key.keysym.scancode == SDL_SCANCODE_F3) {
-                    m_showMainMenu = !m_showMainMenu;
+            case SDL_KEYUP:
+            case SDL_TEXTINPUT:
+            case SDL_MOUSEWHEEL:
+                // A replay owns the input; live keys would make it diverge
+                if (!m_inputReplay) {
+                    HandleInputEvent(event);
                 }
                 break;
                 
             case SDL_WINDOWEVENT:
-                if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-                    // Window was resized
+                // SIZE_CHANGED covers user resizes and fullscreen toggles; moving
+                // to a display with another DPI can change the pixel size alone
+                if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                    event.window.event == SDL_WINDOWEVENT_DISPLAY_CHANGED) {
+                    UpdateOutputSize();
                 }
                 break;
+                
+            case SDL_RENDER_TARGETS_RESET:
+                // Render target contents are lost (and, on some backends, the
+                // font atlas); the UI rebuilds both
+                m_ui->InvalidateCache();
+                break;
+                
+            case SDL_RENDER_DEVICE_RESET:
+                // Every texture is lost: the UI's, and the guest framebuffer's
+                m_ui->InvalidateCache();
+                m_guestFramebuffer->ReleaseTextures();
+                m_guestTick = ~uint64_t(0);
+                break;
         }
     }
+    
+    // The recorded frame's input, stamped as if it had just arrived
+    if (m_inputReplay && m_inputReplay->GetFramesPlayed() > 0) {
+        const RecordedFrame& frame = m_inputReplay->GetFrame();
+        for (uint32_t i = 0; i < frame.eventCount; ++i) {
+            SDL_Event replayed = m_inputReplay->GetEvent(frame.firstEvent + i);
+            replayed.common.timestamp = SDL_GetTicks();
+            HandleInputEvent(replayed);
+        }
+    }
+}
+
+void Emulator::HandleInputEvent(const SDL_Event& event) {
+    // Latency is timed from here, before any recording work
+    auto pumpedAt = std::chrono::steady_clock::now();
+    if (m_inputRecorder) {
+        auto sinceFrameStart = std::chrono::high_resolution_clock::now() - m_lastFrameTime;
+        auto offsetMicros = std::chrono::duration_cast<std::chrono::microseconds>(sinceFrameStart).count();
+        m_inputRecorder->RecordEvent(event, static_cast<uint32_t>(std::max<int64_t>(offsetMicros, 0)));
+    }
+    
+    switch (event.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            HandleKeyEvent(event.key, pumpedAt);
+            break;
+            
+        case SDL_TEXTINPUT:
+            if (m_showMainMenu) {
+                m_ui->HandleTextInput(event.text.text);
+            }
+            break;
+            
+        case SDL_MOUSEWHEEL:
+            if (m_showMainMenu) {
+                m_ui->HandleScroll(static_cast<float>(event.wheel.y));
+            }
+            break;
+    }
+}
+
+void Emulator::HandleKeyEvent(const SDL_KeyboardEvent& key, std::chrono::steady_clock::time_point timestamp) {
+    Action action = m_keyMapper->GetAction(key.keysym.scancode);
+    bool pressed = key.type == SDL_KEYDOWN;
+    
+    // Guest input is applied in push order, so its position in the queue says
+    // which simulation snapshot first shows it
+    auto pushGuestInput = [&](bool down) {
+        if (m_simulation->PushInput({timestamp, action, down})) {
+            ++m_guestInputsPushed;
+            return true;
+        }
+        return false;
+    };
+    
+    // Releases always reach the guest, so a key held while the menu opens can't stick
+    if (!pressed) {
+        if (KeyMapper::IsGuestAction(action)) {
+            pushGuestInput(false);
+        }
+        return;
+    }
+    
+    if (action != Action::None && !KeyMapper::IsGuestAction(action)) {
+        // Host actions toggle, so auto-repeat would make them flicker
+        if (key.repeat == 0) {
+            HandleAction(action);
+            m_inputLatency->OnEventPumped(key.timestamp, timestamp, 0);
+        }
+    }
+    else if (m_showMainMenu) {
+        // Filter editing and scrolling for the APK list
+        m_ui->HandleKey(key.keysym.scancode);
+        if (key.repeat == 0) {
+            m_inputLatency->OnEventPumped(key.timestamp, timestamp, 0);
+        }
+    }
+    else if (action != Action::None && key.repeat == 0) {
+        if (pushGuestInput(true)) {
+            m_inputLatency->OnEventPumped(key.timestamp, timestamp, m_guestInputsPushed);
+        }
+    }
+}
+
+void Emulator::HandleAction(Action action) {
+    switch (action) {
+        case Action::Quit:
+            if (m_showAboutScreen) {
+                m_showAboutScreen = false;
+            } else if (m_showMainMenu) {
+                m_showMainMenu = false;
+            } else {
+                m_running = false;
+            }
+            break;
+        case Action::ToggleDebug:
+            m_showDebugOverlay = !m_showDebugOverlay;
+            break;
+        case Action::ToggleAbout:
+            m_showAboutScreen = !m_showAboutScreen;
+            break;
+        case Action::ToggleMenu:
+            m_showMainMenu = !m_showMainMenu;
+            break;
+        case Action::DumpTelemetry:
+            DumpTelemetry();
+            break;
+        case Action::ToggleTestPattern:
+            m_showTestPattern = !m_showTestPattern;
+            break;
+        case Action::ToggleFullscreen: {
+            // The resulting SIZE_CHANGED event relayouts the UI
+            bool fullscreen = (SDL_GetWindowFlags(m_window) & SDL_WINDOW_FULLSCREEN) != 0;
+            SDL_SetWindowFullscreen(m_window, fullscreen ? 0 : SDL_WINDOW_FULLSCREEN_DESKTOP);
+            break;
+        }
+        case Action::DumpProfile:
+            // The last few seconds of every thread's zones
+            Profiler::WriteTrace("profile_trace.json");
+            break;
+        default:
+            break;
+    }
+}
+
+uint8_t Emulator::GetViewFlags() const {
+    return (m_showDebugOverlay ? 1 : 0) | (m_showAboutScreen ? 2 : 0) |
+           (m_showMainMenu ? 4 : 0) | (m_showTestPattern ? 8 : 0);
+}
+
+void Emulator::SetViewFlags(uint8_t flags) {
+    m_showDebugOverlay = (flags & 1) != 0;
+    m_showAboutScreen = (flags & 2) != 0;
+    m_showMainMenu = (flags & 4) != 0;
+    m_showTestPattern = (flags & 8) != 0;
+}
+
+PacingMode Emulator::GetConfiguredPacing() const {
+    // Only the vsync pacing mode lets the display block presents; the others
+    // pace themselves and must not be quantized to the refresh rate
+    PacingMode defaultPacing = m_configManager->GetVSync() ? PacingMode::VSync : PacingMode::Fixed;
+    return FramePacer::ParseMode(m_configManager->GetFramePacing(), defaultPacing);
+}
+
+void Emulator::ApplyConfig(const ConfigSnapshot& config) {
+    // Unsaved changes of our own win; once written they come back as the next reload
+    if (m_configManager->HasPendingChanges()) {
+        return;
+    }
+    const Settings previous = m_configManager->GetSettings();
+    m_configManager->LoadDocument(config.document);
+    const Settings& current = m_configManager->GetSettings();
+    
+    // Fullscreen first, so a new size applies to the windowed state. Either
+    // one ends in SIZE_CHANGED, which re-lays out the UI.
+    if (current.fullscreen != previous.fullscreen) {
+        SDL_SetWindowFullscreen(m_window, current.fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0);
+    }
+    if (current.windowWidth != previous.windowWidth || current.windowHeight != previous.windowHeight) {
+        SDL_SetWindowSize(m_window, current.windowWidth, current.windowHeight);
+    }
+    
+    // Pacing changes keep the renderer: vsync is switched on the existing one
+    if (current.vsync != previous.vsync || current.targetFps != previous.targetFps ||
+        current.framePacing != previous.framePacing) {
+        PacingMode pacing = GetConfiguredPacing();
+        SDL_RenderSetVSync(m_renderer, pacing == PacingMode::VSync ? 1 : 0);
+        m_framePacer->Configure(pacing, current.targetFps, m_displayHz);
+        std::cout << "Frame pacing: " << FramePacer::GetModeName(m_framePacer->GetMode()) << std::endl;
+    }
+    
+    if (current.guestScaling != previous.guestScaling) {
+        m_guestFramebuffer->SetScaleMode(GuestFramebuffer::ParseScaleMode(current.guestScaling, GuestScaleMode::Integer));
+    }
+    if (current.guestFilter != previous.guestFilter) {
+        m_guestFramebuffer->SetLinearFilter(current.guestFilter == "linear");
+    }
+}
+
+void Emulator::UpdateOutputSize() {
+    // Layout works in output pixels, which differ from window coordinates on high-DPI displays
+    int width = 0;
+    int height = 0;
+    if (SDL_GetRendererOutputSize(m_renderer, &width, &height) != 0 || width <= 0 || height <= 0) {
+        return;
+    }
+    m_ui->SetOutputSize(width, height);
 }
 
 void Emulator::Update(float deltaTime) {
-    // Update logic here
-    // This is where you would update emulator state, APK execution, etc.
+    PROFILE_ZONE("Update");
+    // Emulator state advances in Simulation::Step on the simulation thread;
+    // this is per-frame housekeeping on the main thread
+    
+    // Settings edited on disk since the last frame
+    if (m_configWatcher) {
+        const ConfigSnapshot& config = m_configWatcher->Acquire(m_configReader);
+        if (config.generation != m_configGeneration) {
+            m_configGeneration = config.generation;
+            ApplyConfig(config);
+        }
+    }
+    
+    // Collect APKs the background scan and install queue finished since last frame
+    if (AdoptAPKManager(false)) {
+        m_apkManager->PollScan();
+        m_apkManager->PollInstalls();
+    }
+    
+    m_ui->Update(deltaTime);
 }
 
 void Emulator::Render() {
+    PROFILE_ZONE("Render");
+    // Newest finished tick, blended towards the present
+    const SimulationSnapshot& snapshot = m_simulation->AcquireSnapshot();
+    double alpha = m_deterministic ? 1.0 : Simulation::GetInterpolationAlpha(snapshot, std::chrono::steady_clock::now());
+    m_renderState = Simulation::Interpolate(snapshot, alpha);
+    m_frameStats = m_telemetry->GetStats();
+    
     // Clear screen
     SDL_SetRenderDrawColor(m_renderer, 20, 20, 30, 255);
     SDL_RenderClear(m_renderer);
     
-    // Render main content
-    if (m_showMainMenu) {
-        m_ui->RenderMainMenu();
-    }
-    
     // Render APK content area (placeholder)
     SDL_SetRenderDrawColor(m_renderer, 30, 30, 40, 255);
-    SDL_Rect contentRect = {100, 100, 1080, 520};
+    const SDL_Rect& contentRect = m_ui->GetLayout().GetRect(LayoutRegion::Content);
     SDL_RenderFillRect(m_renderer, &contentRect);
     
-    // Render UI overlays
-    if (m_showDebugOverlay) {
-        std::vector<std::string> debugInfo = {
-            "FPS: " + std::to_string(static_cast<int>(m_fps)),
-            "Frame Time: " + std::to_string(m_frameTime * 1000.0f) + " ms",
-            "Window: " + std::to_string(m_configManager->GetWindowWidth()) + "x" + 
-                       std::to_string(m_configManager->GetWindowHeight()),
-            "Press F1 to toggle debug overlay",
-            "Press F2 to show about screen",
-            "Press F3 to toggle main menu"
-        };
-        m_ui->RenderDebugOverlay(debugInfo);
+    // Guest output, letterboxed in the content area; a new frame only per tick
+    if (m_showTestPattern) {
+        // Stand-in guest output until there is a guest (F5), made on first use
+        if (!m_testPattern) {
+            m_testPattern = std::make_unique<TestPattern>(640, 480, GuestPixelFormat::RGB565);
+        }
+        if (m_renderState.tick != m_guestTick) {
+            m_guestFramebuffer->Upload(m_testPattern->Render(m_renderState.tick));
+            m_guestTick = m_renderState.tick;
+        }
+        m_guestFramebuffer->Draw(contentRect);
+    }
+    
+    // Render main content on top of the content area
+    if (m_showMainMenu) {
+        m_ui->RenderMainMenu();
+        if (m_apkManager) {
+            const APKCatalog& catalog = m_apkManager->GetCatalog();
+            m_ui->RenderAPKList(catalog.GetNames(), catalog.GetGeneration());
+        } else {
+            m_ui->RenderAPKList(kNoAPKs, 0);
+        }
+    }
+    
+    // Render UI overlays. The text is formatted into the frame arena, so a
+    // steady-state frame makes no heap allocations.
+    // Its numbers differ from run to run, so hashed runs never show it
+    if (m_showDebugOverlay && !m_hashFrames) {
+        // 16 lines at most today (10 measurements, 6 key hints); room to grow
+        std::string_view debugInfo[20];
+        size_t lineCount = 0;
+        debugInfo[lineCount++] = m_frameArena->Format("FPS: %d (1%% low: %d)",
+            static_cast<int>(m_frameStats.fps), static_cast<int>(m_frameStats.onePercentLowFps));
+        debugInfo[lineCount++] = m_frameArena->Format("Frame Time: %.3f ms", m_frameTime * 1000.0f);
+        debugInfo[lineCount++] = m_frameArena->Format("p50/p99/p99.9: %.2f / %.2f / %.2f ms",
+            m_frameStats.p50Ms, m_frameStats.p99Ms, m_frameStats.p999Ms);
+        debugInfo[lineCount++] = m_frameArena->Format("Sim Tick: %llu (%llu dropped)",
+            static_cast<unsigned long long>(m_renderState.tick),
+            static_cast<unsigned long long>(snapshot.droppedTicks));
+        const InputLatencyStats& input = snapshot.inputLatency;
+        debugInfo[lineCount++] = m_frameArena->Format("Input: %llu events (%llu dropped), buttons %04x, key-to-guest p50/p99/max %u/%u/%u us",
+            static_cast<unsigned long long>(input.events),
+            static_cast<unsigned long long>(m_simulation->GetDroppedInputs()),
+            m_renderState.buttons, input.p50Micros, input.p99Micros, input.maxMicros);
+        const LatencyHistogram& presented = m_inputLatency->GetHistogram(LatencyStage::Present);
+        debugInfo[lineCount++] = m_frameArena->Format("Pump to present: p50/p99/max %.1f / %.1f / %.1f ms (%llu presses)",
+            presented.GetPercentile(0.50) / 1000.0, presented.GetPercentile(0.99) / 1000.0,
+            presented.GetMax() / 1000.0, static_cast<unsigned long long>(presented.GetCount()));
+        debugInfo[lineCount++] = m_frameArena->Format("Pacing: %s, %llu missed deadlines",
+            FramePacer::GetModeName(m_framePacer->GetMode()),
+            static_cast<unsigned long long>(m_framePacer->GetMissedDeadlines()));
+        const UILayout& layout = m_ui->GetLayout();
+        debugInfo[lineCount++] = m_frameArena->Format("Output: %dx%d @ %.2fx, layout pass %llu",
+            layout.GetOutputWidth(), layout.GetOutputHeight(), layout.GetScale(),
+            static_cast<unsigned long long>(layout.GetGeneration()));
+        debugInfo[lineCount++] = m_frameArena->Format("UI: %d draw calls, %llu rebuilds, %llu layer redraws",
+            m_ui->GetLastDrawCalls(),
+            static_cast<unsigned long long>(m_ui->GetRebuildCount()),
+            static_cast<unsigned long long>(m_ui->GetLayerRedrawCount()));
+        if (m_showTestPattern && m_guestFramebuffer->HasFrame()) {
+            debugInfo[lineCount++] = m_frameArena->Format("Guest: %dx%d %s, %s scaling (%dx in software), %s",
+                m_guestFramebuffer->GetWidth(), m_guestFramebuffer->GetHeight(),
+                PixelConvert::GetFormatName(m_testPattern->GetFormat()),
+                GuestFramebuffer::GetScaleModeName(m_guestFramebuffer->GetScaleMode()),
+                m_guestFramebuffer->GetSoftwareScale(),
+                PixelConvert::GetSimdLevelName(PixelConvert::GetSimdLevel()));
+        }
+        debugInfo[lineCount++] = "Press F1 to toggle debug overlay";
+        debugInfo[lineCount++] = "Press F2 to show about screen";
+        debugInfo[lineCount++] = "Press F3 to toggle main menu";
+        debugInfo[lineCount++] = "Press F4 to dump frame telemetry";
+        debugInfo[lineCount++] = "Press F5 to toggle the test pattern";
+        debugInfo[lineCount++] = "Press F6 to dump a profiler trace";
+        m_ui->RenderDebugOverlay(debugInfo, lineCount);
     }
     
     if (m_showAboutScreen) {
         m_ui->RenderAboutScreen();
     }
     
-    // Always render FPS counter
-    m_ui->RenderFPS(m_fps, m_frameTime);
+    // Always render FPS counter, except where frames must be reproducible
+    if (!m_hashFrames) {
+        m_ui->RenderFPS(static_cast<float>(m_frameStats.fps), m_frameTime);
+    }
     
-    // Present
-    SDL_RenderPresent(m_renderer);
+    // Replay the retained widgets (cached layer, then the per-frame overlays)
+    m_ui->EndFrame();
 }
 
-void Emulator::UpdateFPS(float deltaTime) {
-    m_frameCount++;
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    auto elapsed = std::chrono::duration<float>(currentTime - m_fpsUpdateTime).count();
-    
-    if (elapsed >= 1.0f) {
-        m_fps = m_frameCount / elapsed;
-        m_frameCount = 0;
-        m_fpsUpdateTime = currentTime;
+void Emulator::DumpTelemetry() {
+    // The last few thousand frames as CSV, plus the session's percentiles
+    bool written = m_telemetry->WriteCSV("frame_telemetry.csv") &&
+                   m_telemetry->WriteJSON("frame_telemetry.json");
+    if (written) {
+        std::cout << "Frame telemetry written to frame_telemetry.csv / frame_telemetry.json" << std::endl;
     }
 }
 
 void Emulator::Shutdown() {
-    // Save config
-    if (m_configManager) {
-        m_configManager->SaveConfig();
+    // The simulation thread must be gone before anything it uses
+    if (m_simulation) {
+        m_simulation->Stop();
+    }
+    m_configWatcher.reset();
+    
+    if (m_inputRecorder) {
+        if (m_inputRecorder->Finish()) {
+            std::cout << "Recorded " << m_inputRecorder->GetFrameCount() << " frames of input ("
+                      << m_inputRecorder->GetByteCount() << " bytes) to " << m_inputRecorder->GetPath() << std::endl;
+        }
+        m_inputRecorder.reset();
+    }
+    
+    // Changed settings are saved in the background; wait for the last of them.
+    // A replay's config is the recording's, not the user's, and is never saved.
+    if (m_configManager && !m_inputReplay) {
+        m_configManager->Flush();
     }
     
-    // Cleanup SDL
+    // Cleanup SDL; the UI's and the guest framebuffer's textures belong to the renderer
+    m_guestFramebuffer.reset();
+    m_ui.reset();
     if (m_renderer) {
         SDL_DestroyRenderer(m_renderer);
         m_renderer = nullptr;
@@ -0,0 +1,62 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+FrameArena::FrameArena(size_t capacity)
+    : m_block(std::make_unique<unsigned char[]>(capacity))
+    , m_capacity(capacity)
+    , m_used(0)
+    , m_highWater(0)
+    , m_overflows(0)
+{
+}
+
+FrameArena::~FrameArena() {
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(m_block.get());
+    uintptr_t start = (base + m_used + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    size_t offset = static_cast<size_t>(start - base);
+    if (offset > m_capacity || size > m_capacity - offset) {
+        ++m_overflows;
+        return nullptr;
+    }
+
+    m_used = offset + size;
+    m_highWater = std::max(m_highWater, m_used);
+    return m_block.get() + offset;
+}
+
+std::string_view FrameArena::Format(const char* format, ...) {
+    // Format straight into the free tail, then claim only what was written
+    char* dest = reinterpret_cast<char*>(m_block.get() + m_used);
+    size_t available = m_capacity - m_used;
+    if (available == 0) {
+        ++m_overflows;
+        return std::string_view();
+    }
+
+    va_list args;
+    va_start(args, format);
+    int written = std::vsnprintf(dest, available, format, args);
+    va_end(args);
+    if (written < 0) {
+        return std::string_view();
+    }
+
+    size_t length = static_cast<size_t>(written);
+    if (length >= available) {
+        // Truncated; keep what fit
+        ++m_overflows;
+        length = available - 1;
+    }
+    m_used += length + 1;
+    m_highWater = std::max(m_highWater, m_used);
+    return std::string_view(dest, length);
+}
+
+void FrameArena::Reset() {
+    m_used = 0;
+}
@@ -0,0 +1,182 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr auto kMinSpin = std::chrono::microseconds(200);
+constexpr auto kMaxSpin = std::chrono::milliseconds(4);
+#ifdef _WIN32
+constexpr auto kInitialSpin = std::chrono::milliseconds(2);
+#else
+constexpr auto kInitialSpin = std::chrono::milliseconds(1);
+#endif
+
+// VRR displays stutter when a frame arrives faster than their maximum refresh,
+// so stay a few percent under it
+constexpr double kVRRHeadroom = 0.97;
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+} // namespace
+
+FramePacer::FramePacer()
+    : m_mode(PacingMode::Fixed)
+    , m_period(Clock::duration::zero())
+    , m_started(false)
+    , m_spinThreshold(kInitialSpin)
+    , m_frameCount(0)
+    , m_missedDeadlines(0)
+{
+#ifdef _WIN32
+    // Sleep granularity is ~15.6 ms by default; 1 ms keeps the spin phase short
+    timeBeginPeriod(1);
+#endif
+}
+
+FramePacer::~FramePacer() {
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::Configure(PacingMode mode, double targetFps, double displayHz) {
+    double fps = 0.0;
+    switch (mode) {
+        case PacingMode::Fixed:
+            fps = targetFps;
+            break;
+        case PacingMode::VSync:
+            // Presents block on the display; the period is only used to spot skipped refreshes
+            fps = displayHz > 0.0 ? displayHz : targetFps;
+            break;
+        case PacingMode::VRR:
+            fps = displayHz > 0.0 ? displayHz * kVRRHeadroom : targetFps;
+            if (targetFps > 0.0 && (fps <= 0.0 || targetFps < fps)) {
+                fps = targetFps;
+            }
+            break;
+        case PacingMode::Uncapped:
+            break;
+    }
+
+    if (mode != PacingMode::VSync && fps <= 0.0) {
+        mode = PacingMode::Uncapped;
+    }
+    m_mode = mode;
+    m_period = fps > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps))
+        : Clock::duration::zero();
+    m_started = false;
+}
+
+PacingMode FramePacer::ParseMode(const std::string& name, PacingMode fallback) {
+    if (name == "fixed") return PacingMode::Fixed;
+    if (name == "uncapped") return PacingMode::Uncapped;
+    if (name == "vsync") return PacingMode::VSync;
+    if (name == "vrr") return PacingMode::VRR;
+    return fallback;
+}
+
+const char* FramePacer::GetModeName(PacingMode mode) {
+    switch (mode) {
+        case PacingMode::Fixed: return "fixed";
+        case PacingMode::Uncapped: return "uncapped";
+        case PacingMode::VSync: return "vsync";
+        case PacingMode::VRR: return "vrr";
+    }
+    return "unknown";
+}
+
+double FramePacer::GetTargetFrameSeconds() const {
+    return std::chrono::duration<double>(m_period).count();
+}
+
+void FramePacer::WaitForNextFrame() {
+    Clock::time_point now = Clock::now();
+    ++m_frameCount;
+
+    if (!m_started) {
+        m_started = true;
+        m_lastFrame = now;
+        m_deadline = now + m_period;
+        return;
+    }
+
+    if (m_mode == PacingMode::Uncapped || m_period == Clock::duration::zero()) {
+        m_lastFrame = now;
+        return;
+    }
+
+    if (m_mode == PacingMode::VSync) {
+        // A frame more than half a refresh late made the display show the previous one again
+        if (now - m_lastFrame > m_period + m_period / 2) {
+            ++m_missedDeadlines;
+        }
+        m_lastFrame = now;
+        return;
+    }
+
+    if (now > m_deadline) {
+        // Late: start the next frame right away, and don't try to make up the
+        // lost time with a burst of short frames
+        ++m_missedDeadlines;
+        m_lastFrame = now;
+        m_deadline = now + m_period;
+        return;
+    }
+
+    SleepUntil(m_deadline);
+    m_lastFrame = m_deadline;
+    m_deadline += m_period;
+}
+
+void FramePacer::SleepUntil(Clock::time_point deadline) {
+    // Coarse phase: let the OS have the core while there is plenty of time left
+    for (;;) {
+        Clock::time_point before = Clock::now();
+        Clock::duration remaining = deadline - before;
+        if (remaining <= m_spinThreshold) {
+            break;
+        }
+
+        Clock::duration requested = remaining - m_spinThreshold;
+        std::this_thread::sleep_for(requested);
+        Clock::duration overslept = (Clock::now() - before) - requested;
+
+        // Jump straight up to a worse oversleep, decay slowly back down. Stalls
+        // beyond kMaxSpin are preemption, which no amount of spinning avoids.
+        if (overslept > kMaxSpin) {
+            continue;
+        }
+        if (overslept > m_spinThreshold) {
+            m_spinThreshold = overslept;
+        }
+        else {
+            m_spinThreshold -= (m_spinThreshold - std::max<Clock::duration>(overslept, kMinSpin)) / 16;
+        }
+    }
+
+    // Fine phase: spin out the last stretch on the clock
+    while (Clock::now() < deadline) {
+        CpuRelax();
+    }
+}
@@ -0,0 +1,265 @@
+#include "FrameTelemetry.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr size_t kPhaseCount = static_cast<size_t>(FramePhase::Count);
+
+inline int HighestBit(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(v);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return static_cast<int>(index);
+#else
+    int bit = 0;
+    while (v >>= 1) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+inline uint32_t ToMicros(std::chrono::steady_clock::duration d) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    return static_cast<uint32_t>(std::clamp<int64_t>(us, 0, UINT32_MAX));
+}
+
+json SummarizeHistogram(const LatencyHistogram& histogram) {
+    json summary;
+    summary["count"] = histogram.GetCount();
+    summary["mean_ms"] = histogram.GetMean() / 1000.0;
+    summary["p50_ms"] = histogram.GetPercentile(0.50) / 1000.0;
+    summary["p90_ms"] = histogram.GetPercentile(0.90) / 1000.0;
+    summary["p99_ms"] = histogram.GetPercentile(0.99) / 1000.0;
+    summary["p999_ms"] = histogram.GetPercentile(0.999) / 1000.0;
+    summary["max_ms"] = histogram.GetMax() / 1000.0;
+    return summary;
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() {
+    Reset();
+}
+
+void LatencyHistogram::Record(uint64_t micros) {
+    m_buckets[GetBucketIndex(micros)]++;
+    m_count++;
+    m_sum += micros;
+    m_max = std::max(m_max, micros);
+}
+
+void LatencyHistogram::Reset() {
+    m_buckets.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+}
+
+double LatencyHistogram::GetMean() const {
+    return m_count > 0 ? static_cast<double>(m_sum) / static_cast<double>(m_count) : 0.0;
+}
+
+uint64_t LatencyHistogram::GetPercentile(double q) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(m_count)));
+    target = std::max<uint64_t>(target, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += m_buckets[i];
+        if (seen >= target) {
+            return std::min(GetBucketValue(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+double LatencyHistogram::GetTailMean(double fraction) const {
+    if (m_count == 0) {
+        return 0.0;
+    }
+    uint64_t wanted = static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(m_count)));
+    wanted = std::max<uint64_t>(wanted, 1);
+
+    uint64_t taken = 0;
+    double sum = 0.0;
+    for (size_t i = kBucketCount; i-- > 0 && taken < wanted;) {
+        uint64_t n = std::min<uint64_t>(m_buckets[i], wanted - taken);
+        sum += static_cast<double>(n) * static_cast<double>(std::min(GetBucketValue(i), m_max));
+        taken += n;
+    }
+    return sum / static_cast<double>(taken);
+}
+
+size_t LatencyHistogram::GetBucketIndex(uint64_t micros) {
+    constexpr uint64_t kSubBuckets = 1ull << kSubBucketBits;
+    if (micros < kSubBuckets) {
+        return static_cast<size_t>(micros);
+    }
+    // Keep the top kSubBucketBits bits: [32, 63] << shift
+    int shift = HighestBit(micros) - (kSubBucketBits - 1);
+    size_t index = kSubBuckets + static_cast<size_t>(shift - 1) * (kSubBuckets / 2) +
+                   static_cast<size_t>((micros >> shift) - kSubBuckets / 2);
+    return std::min(index, kBucketCount - 1);
+}
+
+uint64_t LatencyHistogram::GetBucketValue(size_t index) {
+    constexpr uint64_t kSubBuckets = 1ull << kSubBucketBits;
+    if (index < kSubBuckets) {
+        return index;
+    }
+    size_t k = index - kSubBuckets;
+    int shift = static_cast<int>(k / (kSubBuckets / 2)) + 1;
+    uint64_t top = k % (kSubBuckets / 2) + kSubBuckets / 2;
+    // Middle of the bucket's range
+    return (top << shift) + ((1ull << shift) >> 1);
+}
+
+FrameTelemetry::FrameTelemetry()
+    : m_ring(std::make_unique<FrameSample[]>(kCapacity))
+    , m_head(0)
+    , m_inFrame(false)
+{
+}
+
+FrameTelemetry::~FrameTelemetry() {
+}
+
+void FrameTelemetry::BeginFrame() {
+    m_current = FrameSample();
+    m_frameStart = Clock::now();
+    m_phaseStart = m_frameStart;
+    m_inFrame = true;
+}
+
+void FrameTelemetry::EndPhase(FramePhase phase) {
+    Clock::time_point now = Clock::now();
+    m_current.phaseMicros[static_cast<size_t>(phase)] += ToMicros(now - m_phaseStart);
+    m_phaseStart = now;
+}
+
+void FrameTelemetry::EndFrame() {
+    if (!m_inFrame) {
+        return;
+    }
+    m_inFrame = false;
+
+    m_current.totalMicros = ToMicros(Clock::now() - m_frameStart);
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    m_current.frame = head;
+
+    for (size_t i = 0; i < kPhaseCount; ++i) {
+        m_phaseHistograms[i].Record(m_current.phaseMicros[i]);
+    }
+    m_frameHistogram.Record(m_current.totalMicros);
+
+    m_ring[head % kCapacity] = m_current;
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+FrameStats FrameTelemetry::GetStats() const {
+    FrameStats stats;
+    stats.frames = m_frameHistogram.GetCount();
+    stats.p50Ms = m_frameHistogram.GetPercentile(0.50) / 1000.0;
+    stats.p99Ms = m_frameHistogram.GetPercentile(0.99) / 1000.0;
+    stats.p999Ms = m_frameHistogram.GetPercentile(0.999) / 1000.0;
+    stats.maxMs = m_frameHistogram.GetMax() / 1000.0;
+
+    double slowest = m_frameHistogram.GetTailMean(0.01);
+    stats.onePercentLowFps = slowest > 0.0 ? 1e6 / slowest : 0.0;
+
+    // Frames in the most recent second of the ring
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    uint64_t micros = 0;
+    uint64_t frames = 0;
+    while (frames < head && frames < kCapacity && micros < 1000000) {
+        micros += m_ring[(head - 1 - frames) % kCapacity].totalMicros;
+        ++frames;
+    }
+    stats.fps = micros > 0 ? frames * 1e6 / static_cast<double>(micros) : 0.0;
+    return stats;
+}
+
+const LatencyHistogram& FrameTelemetry::GetHistogram(FramePhase phase) const {
+    return m_phaseHistograms[static_cast<size_t>(phase)];
+}
+
+void FrameTelemetry::Reset() {
+    for (auto& histogram : m_phaseHistograms) {
+        histogram.Reset();
+    }
+    m_frameHistogram.Reset();
+}
+
+bool FrameTelemetry::WriteCSV(const std::string& filepath) const {
+    std::ofstream file(filepath, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not write frame telemetry to " << filepath << std::endl;
+        return false;
+    }
+
+    file << "frame";
+    for (size_t i = 0; i < kPhaseCount; ++i) {
+        file << ',' << GetPhaseName(static_cast<FramePhase>(i)) << "_us";
+    }
+    file << ",total_us\n";
+
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    uint64_t first = head > kCapacity ? head - kCapacity : 0;
+    for (uint64_t frame = first; frame < head; ++frame) {
+        const FrameSample& sample = m_ring[frame % kCapacity];
+        file << sample.frame;
+        for (size_t i = 0; i < kPhaseCount; ++i) {
+            file << ',' << sample.phaseMicros[i];
+        }
+        file << ',' << sample.totalMicros << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+bool FrameTelemetry::WriteJSON(const std::string& filepath) const {
+    FrameStats stats = GetStats();
+    json report;
+    report["frames"] = stats.frames;
+    report["fps"] = stats.fps;
+    report["one_percent_low_fps"] = stats.onePercentLowFps;
+    report["frame"] = SummarizeHistogram(m_frameHistogram);
+    for (size_t i = 0; i < kPhaseCount; ++i) {
+        report["phases"][GetPhaseName(static_cast<FramePhase>(i))] = SummarizeHistogram(m_phaseHistograms[i]);
+    }
+
+    std::ofstream file(filepath, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not write frame telemetry to " << filepath << std::endl;
+        return false;
+    }
+    file << report.dump(4);
+    return static_cast<bool>(file);
+}
+
+const char* FrameTelemetry::GetPhaseName(FramePhase phase) {
+    switch (phase) {
+        case FramePhase::Events: return "events";
+        case FramePhase::Update: return "update";
+        case FramePhase::Render: return "render";
+        case FramePhase::Present: return "present";
+        case FramePhase::Sleep: return "sleep";
+        case FramePhase::Count: break;
+    }
+    return "unknown";
+}
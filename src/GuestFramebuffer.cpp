@@ -0,0 +1,206 @@
+#include "GuestFramebuffer.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Bigger software upscales cost more to write than the GPU-less blit saves
+constexpr int kMaxSoftwareScale = 4;
+constexpr int kDefaultMaxTextureSize = 8192;
+
+SDL_Rect CenterIn(const SDL_Rect& area, int width, int height) {
+    return {area.x + (area.w - width) / 2, area.y + (area.h - height) / 2, width, height};
+}
+
+} // namespace
+
+GuestFramebuffer::GuestFramebuffer(SDL_Renderer* renderer)
+    : m_renderer(renderer)
+    , m_textures{nullptr, nullptr}
+    , m_front(-1)
+    , m_textureWidth(0)
+    , m_textureHeight(0)
+    , m_textureScale(1)
+    , m_maxTextureSize(kDefaultMaxTextureSize)
+    , m_frameWidth(0)
+    , m_frameHeight(0)
+    , m_scaleMode(GuestScaleMode::Integer)
+    , m_linearFilter(false)
+    , m_softwareScaling(false)
+    , m_wantedScale(1)
+    , m_uploads(0)
+    , m_uploadedBytes(0)
+{
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(m_renderer, &info) == 0 && info.max_texture_width > 0 && info.max_texture_height > 0) {
+        m_maxTextureSize = std::min(info.max_texture_width, info.max_texture_height);
+    }
+}
+
+GuestFramebuffer::~GuestFramebuffer() {
+    ReleaseTextures();
+}
+
+void GuestFramebuffer::ReleaseTextures() {
+    for (SDL_Texture*& texture : m_textures) {
+        if (texture) {
+            SDL_DestroyTexture(texture);
+            texture = nullptr;
+        }
+    }
+    m_front = -1;
+    m_textureWidth = 0;
+    m_textureHeight = 0;
+}
+
+bool GuestFramebuffer::EnsureTextures(int width, int height, int scale) {
+    // Same scale and scaled size means the same frame size, so the row buffer fits too;
+    // e.g. 320 wide at 4x and 640 wide at 2x share a texture size but not a row buffer
+    if (m_textures[0] && scale == m_textureScale && width * scale == m_textureWidth &&
+        height * scale == m_textureHeight) {
+        return true;
+    }
+    ReleaseTextures();
+
+    for (SDL_Texture*& texture : m_textures) {
+        texture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING,
+                                    width * scale, height * scale);
+        if (!texture) {
+            std::cerr << "Guest framebuffer texture creation failed: " << SDL_GetError() << std::endl;
+            ReleaseTextures();
+            return false;
+        }
+        // The guest image is opaque; skipping blending is noticeably cheaper in software
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    }
+
+    m_textureWidth = width * scale;
+    m_textureHeight = height * scale;
+    m_textureScale = scale;
+    m_rowBuffer.resize(static_cast<size_t>(width));
+    ApplyFilter();
+    return true;
+}
+
+bool GuestFramebuffer::Upload(const GuestFrame& frame) {
+    if (!frame.pixels || frame.width <= 0 || frame.height <= 0) {
+        return false;
+    }
+
+    int scale = m_softwareScaling ? m_wantedScale : 1;
+    scale = std::max(1, std::min(scale, m_maxTextureSize / std::max(frame.width, frame.height)));
+    if (!EnsureTextures(frame.width, frame.height, scale)) {
+        return false;
+    }
+
+    // Write the texture that is not on screen
+    int back = m_front < 0 ? 0 : m_front ^ 1;
+    void* pixels = nullptr;
+    int pitch = 0;
+    if (SDL_LockTexture(m_textures[back], nullptr, &pixels, &pitch) != 0) {
+        std::cerr << "Guest framebuffer lock failed: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    const uint8_t* src = static_cast<const uint8_t*>(frame.pixels);
+    uint8_t* dst = static_cast<uint8_t*>(pixels);
+    size_t width = static_cast<size_t>(frame.width);
+    size_t rowBytes = static_cast<size_t>(m_textureWidth) * 4;
+
+    for (int y = 0; y < frame.height; ++y) {
+        const uint8_t* srcRow = src + static_cast<ptrdiff_t>(y) * frame.pitch;
+        uint8_t* dstRow = dst + static_cast<ptrdiff_t>(y) * scale * pitch;
+        if (scale == 1) {
+            PixelConvert::ConvertRow(frame.format, srcRow, reinterpret_cast<uint32_t*>(dstRow), width);
+            continue;
+        }
+
+        // Scale the row once, then repeat it for the remaining rows of the block
+        PixelConvert::ConvertRow(frame.format, srcRow, m_rowBuffer.data(), width);
+        PixelConvert::ScaleRow(m_rowBuffer.data(), reinterpret_cast<uint32_t*>(dstRow), width, scale);
+        for (int repeat = 1; repeat < scale; ++repeat) {
+            std::memcpy(dstRow + static_cast<ptrdiff_t>(repeat) * pitch, dstRow, rowBytes);
+        }
+    }
+
+    SDL_UnlockTexture(m_textures[back]);
+    m_front = back;
+    m_frameWidth = frame.width;
+    m_frameHeight = frame.height;
+    ++m_uploads;
+    m_uploadedBytes += static_cast<uint64_t>(rowBytes) * m_textureHeight;
+    return true;
+}
+
+int GuestFramebuffer::GetIntegerScale(const SDL_Rect& area) const {
+    if (m_frameWidth <= 0 || m_frameHeight <= 0) {
+        return 1;
+    }
+    return std::min(area.w / m_frameWidth, area.h / m_frameHeight);
+}
+
+SDL_Rect GuestFramebuffer::GetDestRect(const SDL_Rect& area) const {
+    if (m_frameWidth <= 0 || m_frameHeight <= 0 || m_scaleMode == GuestScaleMode::Stretch) {
+        return area;
+    }
+
+    int scale = GetIntegerScale(area);
+    if (m_scaleMode == GuestScaleMode::Integer && scale >= 1) {
+        return CenterIn(area, m_frameWidth * scale, m_frameHeight * scale);
+    }
+
+    // Aspect fit: full width if the area is relatively taller than the frame, else full height
+    int64_t widthByHeight = static_cast<int64_t>(area.w) * m_frameHeight;
+    int64_t heightByWidth = static_cast<int64_t>(area.h) * m_frameWidth;
+    if (widthByHeight <= heightByWidth) {
+        return CenterIn(area, area.w, static_cast<int>(widthByHeight / m_frameWidth));
+    }
+    return CenterIn(area, static_cast<int>(heightByWidth / m_frameHeight), area.h);
+}
+
+bool GuestFramebuffer::Draw(const SDL_Rect& area) {
+    // The next upload bakes in the whole-number scale for this area, which
+    // only pays off when the result is then drawn 1:1
+    m_wantedScale = m_scaleMode == GuestScaleMode::Integer ?
+                    std::max(1, std::min(GetIntegerScale(area), kMaxSoftwareScale)) : 1;
+
+    if (!HasFrame()) {
+        return false;
+    }
+    SDL_Rect dest = GetDestRect(area);
+    return SDL_RenderCopy(m_renderer, m_textures[m_front], nullptr, &dest) == 0;
+}
+
+void GuestFramebuffer::SetLinearFilter(bool linear) {
+    m_linearFilter = linear;
+    ApplyFilter();
+}
+
+void GuestFramebuffer::SetSoftwareScaling(bool enabled) {
+    m_softwareScaling = enabled;
+}
+
+void GuestFramebuffer::ApplyFilter() {
+    for (SDL_Texture* texture : m_textures) {
+        if (texture) {
+            SDL_SetTextureScaleMode(texture, m_linearFilter ? SDL_ScaleModeLinear : SDL_ScaleModeNearest);
+        }
+    }
+}
+
+GuestScaleMode GuestFramebuffer::ParseScaleMode(const std::string& name, GuestScaleMode fallback) {
+    if (name == "integer") return GuestScaleMode::Integer;
+    if (name == "aspect") return GuestScaleMode::Aspect;
+    if (name == "stretch") return GuestScaleMode::Stretch;
+    return fallback;
+}
+
+const char* GuestFramebuffer::GetScaleModeName(GuestScaleMode mode) {
+    switch (mode) {
+        case GuestScaleMode::Integer: return "integer";
+        case GuestScaleMode::Aspect: return "aspect";
+        case GuestScaleMode::Stretch: return "stretch";
+    }
+    return "unknown";
+}
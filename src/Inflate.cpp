@@ -0,0 +1,382 @@
+#include "Inflate.h"
+
+namespace {
+
+constexpr int kMaxBits = 15;
+constexpr int kMaxLitCodes = 286;
+constexpr int kMaxDistCodes = 30;
+constexpr int kFixedLitCodes = 288;
+constexpr int kFastBits = 9;
+
+struct Huffman {
+    short count[kMaxBits + 1];   // number of symbols of each code length
+    short symbol[kFixedLitCodes]; // symbols ordered by code
+    // Direct lookup for codes up to kFastBits long, indexed by the next input bits:
+    // (length << 12) | symbol, or 0 when the code is longer
+    uint16_t fast[1 << kFastBits];
+};
+
+struct State {
+    const uint8_t* in;
+    size_t inSize;
+    size_t inPos;
+    uint32_t bitBuf;
+    int bitCount;
+
+    uint8_t* out;
+    size_t outSize;
+    size_t outPos;
+};
+
+// Returns -1 when reading past the end of the input
+int Bits(State& s, int need) {
+    uint32_t val = s.bitBuf;
+    while (s.bitCount < need) {
+        if (s.inPos >= s.inSize) {
+            return -1;
+        }
+        val |= static_cast<uint32_t>(s.in[s.inPos++]) << s.bitCount;
+        s.bitCount += 8;
+    }
+    s.bitBuf = val >> need;
+    s.bitCount -= need;
+    return static_cast<int>(val & ((1u << need) - 1));
+}
+
+bool Stored(State& s) {
+    // Discard remaining bits in the current byte and give back any whole
+    // bytes the decoder's lookahead already pulled in
+    s.inPos -= static_cast<size_t>(s.bitCount / 8);
+    s.bitBuf = 0;
+    s.bitCount = 0;
+
+    if (s.inPos + 4 > s.inSize) {
+        return false;
+    }
+    unsigned len = s.in[s.inPos] | (s.in[s.inPos + 1] << 8);
+    unsigned nlen = s.in[s.inPos + 2] | (s.in[s.inPos + 3] << 8);
+    s.inPos += 4;
+    if (len != (~nlen & 0xffffu)) {
+        return false;
+    }
+    if (s.inPos + len > s.inSize || s.outPos + len > s.outSize) {
+        return false;
+    }
+    for (unsigned i = 0; i < len; ++i) {
+        s.out[s.outPos++] = s.in[s.inPos++];
+    }
+    return true;
+}
+
+int DecodeSlow(State& s, const Huffman& h) {
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len <= kMaxBits; ++len) {
+        int bit = Bits(s, 1);
+        if (bit < 0) {
+            return -1;
+        }
+        code |= bit;
+        int count = h.count[len];
+        if (code - count < first) {
+            return h.symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+int Decode(State& s, const Huffman& h) {
+    while (s.bitCount < kFastBits && s.inPos < s.inSize) {
+        s.bitBuf |= static_cast<uint32_t>(s.in[s.inPos++]) << s.bitCount;
+        s.bitCount += 8;
+    }
+    uint16_t entry = h.fast[s.bitBuf & ((1u << kFastBits) - 1)];
+    int len = entry >> 12;
+    if (len != 0 && len <= s.bitCount) {
+        s.bitBuf >>= len;
+        s.bitCount -= len;
+        return entry & 0x0fff;
+    }
+    return DecodeSlow(s, h);
+}
+
+// Returns 0 for a complete code, >0 for an incomplete one, <0 for an oversubscribed one
+int Construct(Huffman& h, const short* length, int n) {
+    for (int len = 0; len <= kMaxBits; ++len) {
+        h.count[len] = 0;
+    }
+    for (int sym = 0; sym < n; ++sym) {
+        h.count[length[sym]]++;
+    }
+    if (h.count[0] == n) {
+        for (int i = 0; i < (1 << kFastBits); ++i) {
+            h.fast[i] = 0;
+        }
+        return 0;
+    }
+
+    int left = 1;
+    for (int len = 1; len <= kMaxBits; ++len) {
+        left <<= 1;
+        left -= h.count[len];
+        if (left < 0) {
+            return left;
+        }
+    }
+
+    short offs[kMaxBits + 1];
+    offs[1] = 0;
+    for (int len = 1; len < kMaxBits; ++len) {
+        offs[len + 1] = static_cast<short>(offs[len] + h.count[len]);
+    }
+    for (int sym = 0; sym < n; ++sym) {
+        if (length[sym] != 0) {
+            h.symbol[offs[length[sym]]++] = static_cast<short>(sym);
+        }
+    }
+
+    // Canonical codes are assigned in symbol order per length; DEFLATE sends them
+    // MSB first, so the lookup index is the bit-reversed code
+    for (int i = 0; i < (1 << kFastBits); ++i) {
+        h.fast[i] = 0;
+    }
+    int code = 0;
+    int index = 0;
+    for (int len = 1; len <= kFastBits; ++len) {
+        for (int i = 0; i < h.count[len]; ++i, ++code, ++index) {
+            int reversed = 0;
+            for (int b = 0; b < len; ++b) {
+                reversed |= ((code >> b) & 1) << (len - 1 - b);
+            }
+            uint16_t entry = static_cast<uint16_t>((len << 12) | h.symbol[index]);
+            for (int fill = reversed; fill < (1 << kFastBits); fill += (1 << len)) {
+                h.fast[fill] = entry;
+            }
+        }
+        code <<= 1;
+    }
+    return left;
+}
+
+bool Codes(State& s, const Huffman& lencode, const Huffman& distcode) {
+    static const short kLenBase[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const short kLenExtra[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const short kDistBase[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+        8193, 12289, 16385, 24577};
+    static const short kDistExtra[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    for (;;) {
+        int symbol = Decode(s, lencode);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 256) {
+            if (s.outPos >= s.outSize) {
+                return false;
+            }
+            s.out[s.outPos++] = static_cast<uint8_t>(symbol);
+        }
+        else if (symbol == 256) {
+            return true;
+        }
+        else {
+            symbol -= 257;
+            if (symbol >= 29) {
+                return false;
+            }
+            int extra = Bits(s, kLenExtra[symbol]);
+            if (extra < 0) {
+                return false;
+            }
+            size_t len = static_cast<size_t>(kLenBase[symbol] + extra);
+
+            symbol = Decode(s, distcode);
+            if (symbol < 0 || symbol >= 30) {
+                return false;
+            }
+            extra = Bits(s, kDistExtra[symbol]);
+            if (extra < 0) {
+                return false;
+            }
+            size_t dist = static_cast<size_t>(kDistBase[symbol] + extra);
+
+            if (dist > s.outPos || s.outPos + len > s.outSize) {
+                return false;
+            }
+            // Byte-wise copy: source and destination may overlap
+            const uint8_t* from = s.out + s.outPos - dist;
+            uint8_t* to = s.out + s.outPos;
+            for (size_t i = 0; i < len; ++i) {
+                to[i] = from[i];
+            }
+            s.outPos += len;
+        }
+    }
+}
+
+bool Fixed(State& s) {
+    static Huffman lencode;
+    static Huffman distcode;
+    static const bool built = [] {
+        short lengths[kFixedLitCodes];
+        int sym = 0;
+        for (; sym < 144; ++sym) lengths[sym] = 8;
+        for (; sym < 256; ++sym) lengths[sym] = 9;
+        for (; sym < 280; ++sym) lengths[sym] = 7;
+        for (; sym < kFixedLitCodes; ++sym) lengths[sym] = 8;
+        Construct(lencode, lengths, kFixedLitCodes);
+
+        for (sym = 0; sym < kMaxDistCodes; ++sym) lengths[sym] = 5;
+        Construct(distcode, lengths, kMaxDistCodes);
+        return true;
+    }();
+    (void)built;
+
+    return Codes(s, lencode, distcode);
+}
+
+bool Dynamic(State& s) {
+    static const short kOrder[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    int nlen = Bits(s, 5);
+    int ndist = Bits(s, 5);
+    int ncode = Bits(s, 4);
+    if (nlen < 0 || ndist < 0 || ncode < 0) {
+        return false;
+    }
+    nlen += 257;
+    ndist += 1;
+    ncode += 4;
+    if (nlen > kMaxLitCodes || ndist > kMaxDistCodes) {
+        return false;
+    }
+
+    short lengths[kMaxLitCodes + kMaxDistCodes];
+    int index = 0;
+    for (; index < ncode; ++index) {
+        int len = Bits(s, 3);
+        if (len < 0) {
+            return false;
+        }
+        lengths[kOrder[index]] = static_cast<short>(len);
+    }
+    for (; index < 19; ++index) {
+        lengths[kOrder[index]] = 0;
+    }
+
+    Huffman lencode;
+    Huffman distcode;
+    if (Construct(lencode, lengths, 19) != 0) {
+        return false;
+    }
+
+    index = 0;
+    while (index < nlen + ndist) {
+        int symbol = Decode(s, lencode);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[index++] = static_cast<short>(symbol);
+            continue;
+        }
+
+        short len = 0;
+        int repeat = 0;
+        if (symbol == 16) {
+            if (index == 0) {
+                return false;
+            }
+            len = lengths[index - 1];
+            repeat = Bits(s, 2);
+            if (repeat < 0) return false;
+            repeat += 3;
+        }
+        else if (symbol == 17) {
+            repeat = Bits(s, 3);
+            if (repeat < 0) return false;
+            repeat += 3;
+        }
+        else {
+            repeat = Bits(s, 7);
+            if (repeat < 0) return false;
+            repeat += 11;
+        }
+        if (index + repeat > nlen + ndist) {
+            return false;
+        }
+        while (repeat--) {
+            lengths[index++] = len;
+        }
+    }
+
+    // An end-of-block code is required
+    if (lengths[256] == 0) {
+        return false;
+    }
+
+    // Incomplete codes are only allowed for a single length-1 code
+    int err = Construct(lencode, lengths, nlen);
+    if (err < 0 || (err > 0 && nlen - lencode.count[0] != 1)) {
+        return false;
+    }
+    err = Construct(distcode, lengths + nlen, ndist);
+    if (err < 0 || (err > 0 && ndist - distcode.count[0] != 1)) {
+        return false;
+    }
+
+    return Codes(s, lencode, distcode);
+}
+
+} // namespace
+
+bool InflateRaw(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize, size_t* written) {
+    State s;
+    s.in = src;
+    s.inSize = srcSize;
+    s.inPos = 0;
+    s.bitBuf = 0;
+    s.bitCount = 0;
+    s.out = dst;
+    s.outSize = dstSize;
+    s.outPos = 0;
+
+    int last = 0;
+    do {
+        last = Bits(s, 1);
+        int type = Bits(s, 2);
+        if (last < 0 || type < 0) {
+            return false;
+        }
+
+        bool ok = false;
+        switch (type) {
+            case 0: ok = Stored(s); break;
+            case 1: ok = Fixed(s); break;
+            case 2: ok = Dynamic(s); break;
+            default: ok = false; break;
+        }
+        if (!ok) {
+            return false;
+        }
+    } while (!last);
+
+    if (written) {
+        *written = s.outPos;
+    }
+    return true;
+}
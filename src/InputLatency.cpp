@@ -0,0 +1,87 @@
+#include "InputLatency.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+
+InputLatencyTracker::InputLatencyTracker()
+    : m_pending()
+    , m_pendingCount(0)
+    , m_overflows(0)
+{
+}
+
+void InputLatencyTracker::OnEventPumped(uint32_t sdlTimestamp, std::chrono::steady_clock::time_point pumpedAt,
+                                        uint64_t guestSequence) {
+    // SDL stamps events in whole milliseconds, too coarse to measure the later
+    // stages from; its age only gives the time the event sat in the queue
+    uint32_t ageMillis = SDL_GetTicks() - sdlTimestamp;
+    m_histograms[static_cast<size_t>(LatencyStage::Queue)].Record(uint64_t(ageMillis) * 1000);
+
+    if (m_pendingCount == kMaxPending) {
+        // Something is not reaching the screen; the oldest event gives way
+        std::move(m_pending.begin() + 1, m_pending.end(), m_pending.begin());
+        --m_pendingCount;
+        ++m_overflows;
+    }
+    Pending& pending = m_pending[m_pendingCount++];
+    pending.pumpedAt = pumpedAt;
+    pending.guestSequence = guestSequence;
+    pending.updated = false;
+    pending.rendered = false;
+}
+
+void InputLatencyTracker::OnUpdateDone(std::chrono::steady_clock::time_point now) {
+    for (size_t i = 0; i < m_pendingCount; ++i) {
+        Pending& pending = m_pending[i];
+        if (!pending.updated) {
+            pending.updated = true;
+            Record(LatencyStage::Update, pending, now);
+        }
+    }
+}
+
+void InputLatencyTracker::OnRenderDone(std::chrono::steady_clock::time_point now, uint64_t guestEvents) {
+    for (size_t i = 0; i < m_pendingCount; ++i) {
+        Pending& pending = m_pending[i];
+        // Guest input shows once the rendered snapshot has applied it
+        if (pending.updated && !pending.rendered && guestEvents >= pending.guestSequence) {
+            pending.rendered = true;
+            Record(LatencyStage::Render, pending, now);
+        }
+    }
+}
+
+void InputLatencyTracker::OnPresentDone(std::chrono::steady_clock::time_point now) {
+    size_t kept = 0;
+    for (size_t i = 0; i < m_pendingCount; ++i) {
+        if (m_pending[i].rendered) {
+            Record(LatencyStage::Present, m_pending[i], now);
+        } else {
+            m_pending[kept++] = m_pending[i];
+        }
+    }
+    m_pendingCount = kept;
+}
+
+void InputLatencyTracker::Reset() {
+    m_pendingCount = 0;
+    m_overflows = 0;
+    for (LatencyHistogram& histogram : m_histograms) {
+        histogram.Reset();
+    }
+}
+
+const char* InputLatencyTracker::GetStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::Queue: return "sdl queue";
+        case LatencyStage::Update: return "update";
+        case LatencyStage::Render: return "render";
+        case LatencyStage::Present: return "present";
+        case LatencyStage::Count: break;
+    }
+    return "unknown";
+}
+
+void InputLatencyTracker::Record(LatencyStage stage, const Pending& pending, std::chrono::steady_clock::time_point now) {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now - pending.pumpedAt).count();
+    m_histograms[static_cast<size_t>(stage)].Record(static_cast<uint64_t>(std::max<int64_t>(micros, 0)));
+}
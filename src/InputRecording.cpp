@@ -0,0 +1,278 @@
+#include "InputRecording.h"
+#include "ByteReader.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+constexpr uint32_t kRecordingMagic = 0x52494d45; // "EMIR"
+constexpr uint32_t kRecordingVersion = 1;
+constexpr size_t kHeaderSize = 20;
+
+enum RecordTag : uint8_t {
+    kTagKey = 1,
+    kTagText = 2,
+    kTagWheel = 3,
+    kTagView = 4,
+    kTagFrame = 5,
+};
+
+void WriteLE32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        out += static_cast<char>((v >> (i * 8)) & 0xff);
+    }
+}
+
+void WriteVarint(std::string& out, uint32_t v) {
+    while (v >= 0x80) {
+        out += static_cast<char>((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    out += static_cast<char>(v);
+}
+
+bool ReadVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t byte = *p++;
+        v |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t ZigZag(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+int32_t UnZigZag(uint32_t v) {
+    return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+} // namespace
+
+InputRecorder::InputRecorder()
+    : m_file(nullptr)
+    , m_frames(0)
+    , m_written(0)
+    , m_failed(false)
+{
+}
+
+InputRecorder::~InputRecorder() {
+    Finish();
+}
+
+bool InputRecorder::Begin(const std::string& filepath, const std::string& config, int outputWidth, int outputHeight) {
+    Finish();
+    m_file = std::fopen(filepath.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "Error: Could not create input recording " << filepath << std::endl;
+        return false;
+    }
+    m_path = filepath;
+    m_frames = 0;
+    m_written = 0;
+    m_failed = false;
+
+    // Reserved once; Flush keeps the capacity, so steady-state frames don't allocate
+    m_buffer.clear();
+    m_buffer.reserve(kFlushSize + config.size() + kHeaderSize);
+    WriteLE32(m_buffer, kRecordingMagic);
+    WriteLE32(m_buffer, kRecordingVersion);
+    WriteLE32(m_buffer, static_cast<uint32_t>(outputWidth));
+    WriteLE32(m_buffer, static_cast<uint32_t>(outputHeight));
+    WriteLE32(m_buffer, static_cast<uint32_t>(config.size()));
+    m_buffer += config;
+    return true;
+}
+
+void InputRecorder::RecordEvent(const SDL_Event& event, uint32_t offsetMicros) {
+    if (!m_file) {
+        return;
+    }
+    switch (event.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            m_buffer += static_cast<char>(kTagKey);
+            WriteVarint(m_buffer, static_cast<uint32_t>(event.key.keysym.scancode));
+            WriteVarint(m_buffer, (event.type == SDL_KEYDOWN ? 1u : 0u) | (event.key.repeat ? 2u : 0u));
+            break;
+        case SDL_TEXTINPUT: {
+            size_t length = strnlen(event.text.text, sizeof(event.text.text));
+            m_buffer += static_cast<char>(kTagText);
+            WriteVarint(m_buffer, static_cast<uint32_t>(length));
+            m_buffer.append(event.text.text, length);
+            break;
+        }
+        case SDL_MOUSEWHEEL:
+            m_buffer += static_cast<char>(kTagWheel);
+            WriteVarint(m_buffer, ZigZag(event.wheel.y));
+            break;
+        default:
+            return;
+    }
+    WriteVarint(m_buffer, offsetMicros);
+}
+
+void InputRecorder::RecordView(uint8_t viewFlags) {
+    if (!m_file) {
+        return;
+    }
+    m_buffer += static_cast<char>(kTagView);
+    WriteVarint(m_buffer, viewFlags);
+}
+
+void InputRecorder::EndFrame(uint32_t deltaMicros, uint32_t ticks) {
+    if (!m_file) {
+        return;
+    }
+    m_buffer += static_cast<char>(kTagFrame);
+    WriteVarint(m_buffer, deltaMicros);
+    WriteVarint(m_buffer, ticks);
+    ++m_frames;
+    if (m_buffer.size() >= kFlushSize) {
+        Flush();
+    }
+}
+
+bool InputRecorder::Finish() {
+    if (!m_file) {
+        return !m_failed;
+    }
+    Flush();
+    if (std::fclose(m_file) != 0) {
+        m_failed = true;
+    }
+    m_file = nullptr;
+    if (m_failed) {
+        std::cerr << "Error: Could not write input recording " << m_path << std::endl;
+    }
+    return !m_failed;
+}
+
+void InputRecorder::Flush() {
+    if (!m_buffer.empty() && std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()) {
+        m_failed = true;
+    }
+    m_written += m_buffer.size();
+    m_buffer.clear();
+}
+
+InputReplay::InputReplay()
+    : m_outputWidth(0)
+    , m_outputHeight(0)
+    , m_played(0)
+{
+}
+
+InputReplay::~InputReplay() {
+}
+
+bool InputReplay::Load(const std::string& filepath) {
+    m_frames.clear();
+    m_events.clear();
+    m_played = 0;
+
+    MappedFile file;
+    if (!file.Open(filepath)) {
+        std::cerr << "Error: Could not open input recording " << filepath << std::endl;
+        return false;
+    }
+    const uint8_t* p = file.GetData();
+    const uint8_t* end = p + file.GetSize();
+    if (file.GetSize() < kHeaderSize || ReadLE32(p) != kRecordingMagic || ReadLE32(p + 4) != kRecordingVersion) {
+        std::cerr << "Error: " << filepath << " is not an input recording (or from another version)" << std::endl;
+        return false;
+    }
+    m_outputWidth = static_cast<int>(ReadLE32(p + 8));
+    m_outputHeight = static_cast<int>(ReadLE32(p + 12));
+    uint32_t configLength = ReadLE32(p + 16);
+    p += kHeaderSize;
+    if (static_cast<size_t>(end - p) < configLength) {
+        std::cerr << "Error: " << filepath << " is truncated" << std::endl;
+        return false;
+    }
+    m_config.assign(reinterpret_cast<const char*>(p), configLength);
+    p += configLength;
+
+    // A recording cut short (crash, kill) replays up to its last whole frame
+    RecordedFrame frame;
+    bool valid = true;
+    while (p < end && valid) {
+        uint8_t tag = *p++;
+        uint32_t a = 0;
+        uint32_t b = 0;
+        SDL_Event event;
+        std::memset(&event, 0, sizeof(event));
+        switch (tag) {
+            case kTagKey:
+                valid = ReadVarint(p, end, a) && ReadVarint(p, end, b) && a < SDL_NUM_SCANCODES;
+                event.type = (b & 1) ? SDL_KEYDOWN : SDL_KEYUP;
+                event.key.state = (b & 1) ? SDL_PRESSED : SDL_RELEASED;
+                event.key.repeat = (b & 2) ? 1 : 0;
+                event.key.keysym.scancode = static_cast<SDL_Scancode>(a);
+                event.key.keysym.sym = SDL_GetKeyFromScancode(event.key.keysym.scancode);
+                break;
+            case kTagText:
+                valid = ReadVarint(p, end, a) && a < sizeof(event.text.text) && static_cast<size_t>(end - p) >= a;
+                if (valid) {
+                    event.type = SDL_TEXTINPUT;
+                    std::memcpy(event.text.text, p, a);
+                    p += a;
+                }
+                break;
+            case kTagWheel:
+                valid = ReadVarint(p, end, a);
+                event.type = SDL_MOUSEWHEEL;
+                event.wheel.y = UnZigZag(a);
+                break;
+            case kTagView:
+                valid = ReadVarint(p, end, a);
+                frame.viewFlags = static_cast<int>(a & 0xff);
+                continue;
+            case kTagFrame:
+                valid = ReadVarint(p, end, frame.deltaMicros) && ReadVarint(p, end, frame.ticks);
+                if (valid) {
+                    m_frames.push_back(frame);
+                    frame = RecordedFrame();
+                    frame.firstEvent = static_cast<uint32_t>(m_events.size());
+                }
+                continue;
+            default:
+                valid = false;
+                continue;
+        }
+        // The pump offset is kept in the file for analysis; replays pump at frame start
+        uint32_t offsetMicros = 0;
+        valid = valid && ReadVarint(p, end, offsetMicros);
+        if (valid) {
+            m_events.push_back(event);
+            ++frame.eventCount;
+        }
+    }
+    if (!valid) {
+        // Drop the partial frame's events
+        m_events.resize(frame.firstEvent);
+        std::cerr << "Warning: " << filepath << " ends in a damaged record; replaying its first "
+                  << m_frames.size() << " frames" << std::endl;
+    }
+    if (m_frames.empty()) {
+        std::cerr << "Error: " << filepath << " holds no frames" << std::endl;
+        return false;
+    }
+    std::cout << "Input recording: " << m_frames.size() << " frames, " << m_events.size()
+              << " input events" << std::endl;
+    return true;
+}
+
+bool InputReplay::NextFrame() {
+    if (IsFinished()) {
+        return false;
+    }
+    ++m_played;
+    return true;
+}
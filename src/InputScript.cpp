@@ -0,0 +1,125 @@
+#include "InputScript.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const char* const kDefaultScript =
+    "# Close the main menu so the arrows reach the guest\n"
+    "10 F3 tap\n"
+    "# Guest d-pad, four presses a second each at 60 fps\n"
+    "30 Up tap every 15\n"
+    "37 Down tap every 15\n"
+    "# Host input: the about screen on and off\n"
+    "45 F2 tap every 60\n";
+
+} // namespace
+
+InputScript::InputScript() {
+}
+
+InputScript::~InputScript() {
+}
+
+bool InputScript::Load(const std::string& filepath) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open input script " << filepath << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return Parse(buffer.str(), filepath);
+}
+
+void InputScript::LoadDefault() {
+    Parse(kDefaultScript, "built-in script");
+}
+
+void InputScript::Inject(uint64_t frame) {
+    // Releases first, so a tap repeating every frame still alternates
+    for (const Step& step : m_steps) {
+        bool release = (step.kind == StepKind::Up && IsDue(step, frame)) ||
+                       (step.kind == StepKind::Tap && frame > 0 && IsDue(step, frame - 1));
+        if (release) {
+            PushKey(step.scancode, false);
+        }
+    }
+    for (const Step& step : m_steps) {
+        if (step.kind != StepKind::Up && IsDue(step, frame)) {
+            PushKey(step.scancode, true);
+        }
+    }
+}
+
+bool InputScript::Parse(const std::string& text, const std::string& source) {
+    std::vector<Step> steps;
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        std::istringstream fields(line);
+        std::string frameText;
+        if (!(fields >> frameText)) {
+            continue;
+        }
+
+        Step step = {};
+        std::string keyName;
+        std::string kind;
+        std::string every;
+        bool valid = false;
+        try {
+            step.frame = std::stoull(frameText);
+            valid = static_cast<bool>(fields >> keyName >> kind);
+        } catch (const std::exception&) {
+            valid = false;
+        }
+        if (valid && (fields >> every)) {
+            valid = every == "every" && (fields >> step.every) && step.every > 0;
+        }
+        step.scancode = SDL_GetScancodeFromName(keyName.c_str());
+        if (kind == "down") {
+            step.kind = StepKind::Down;
+        } else if (kind == "up") {
+            step.kind = StepKind::Up;
+        } else if (kind == "tap") {
+            step.kind = StepKind::Tap;
+        } else {
+            valid = false;
+        }
+        if (!valid || step.scancode == SDL_SCANCODE_UNKNOWN) {
+            std::cerr << "Error: " << source << ":" << lineNumber << ": expected '<frame> <key> <down|up|tap> [every <frames>]'" << std::endl;
+            return false;
+        }
+        steps.push_back(step);
+    }
+
+    m_steps = std::move(steps);
+    std::cout << "Input script: " << m_steps.size() << " steps from " << source << std::endl;
+    return true;
+}
+
+void InputScript::PushKey(SDL_Scancode scancode, bool pressed) {
+    SDL_Event event = {};
+    event.type = pressed ? SDL_KEYDOWN : SDL_KEYUP;
+    event.key.timestamp = SDL_GetTicks();
+    event.key.state = pressed ? SDL_PRESSED : SDL_RELEASED;
+    event.key.keysym.scancode = scancode;
+    event.key.keysym.sym = SDL_GetKeyFromScancode(scancode);
+    SDL_PushEvent(&event);
+}
+
+bool InputScript::IsDue(const Step& step, uint64_t frame) {
+    if (frame < step.frame) {
+        return false;
+    }
+    return step.every == 0 ? frame == step.frame : (frame - step.frame) % step.every == 0;
+}
@@ -1,5 +1,33 @@
 #include "KeyMapper.h"
-#include <sstream>
+
+namespace {
+
+// Indexed by Action
+const char* const kActionNames[] = {
+    "",
+    "quit",
+    "toggle_debug",
+    "toggle_about",
+    "toggle_menu",
+    "dump_telemetry",
+    "toggle_test_pattern",
+    "toggle_fullscreen",
+    "dump_profile",
+    "guest_up",
+    "guest_down",
+    "guest_left",
+    "guest_right",
+    "guest_select",
+    "guest_back",
+    "guest_home",
+    "guest_menu",
+};
+static_assert(sizeof(kActionNames) / sizeof(kActionNames[0]) == static_cast<size_t>(Action::Count),
+              "every action needs a name");
+static_assert(static_cast<int>(Action::Count) - static_cast<int>(Action::GuestUp) <= 32,
+              "guest actions must fit the button mask");
+
+} // namespace
 
 KeyMapper::KeyMapper() {
     SetDefaultMappings();
@@ -8,20 +36,20 @@ KeyMapper::KeyMapper() {
 KeyMapper::~KeyMapper() {
 }
 
-void KeyMapper::MapKey(SDL_Scancode scancode, const std::string& action) {
-    m_keyMappings[scancode] = action;
-}
-
-std::string KeyMapper::GetAction(SDL_Scancode scancode) const {
-    auto it = m_keyMappings.find(scancode);
-    if (it != m_keyMappings.end()) {
-        return it->second;
+void KeyMapper::MapKey(SDL_Scancode scancode, Action action) {
+    size_t index = static_cast<size_t>(scancode);
+    if (index < kScancodeCount) {
+        m_table[index] = action;
     }
-    return "";
 }
 
-bool KeyMapper::IsKeyMapped(SDL_Scancode scancode) const {
-    return m_keyMappings.find(scancode) != m_keyMappings.end();
+bool KeyMapper::MapKey(SDL_Scancode scancode, const std::string& actionName) {
+    Action action = FindAction(actionName);
+    if (action == Action::None) {
+        return false;
+    }
+    MapKey(scancode, action);
+    return true;
 }
 
 std::string KeyMapper::GetKeyName(SDL_Scancode scancode) {
@@ -29,32 +57,61 @@ std::string KeyMapper::GetKeyName(SDL_Scancode scancode) {
     return name ? std::string(name) : "Unknown";
 }
 
+const char* KeyMapper::GetActionName(Action action) {
+    size_t index = static_cast<size_t>(action);
+    return index < static_cast<size_t>(Action::Count) ? kActionNames[index] : "";
+}
+
+Action KeyMapper::FindAction(const std::string& name) {
+    for (size_t i = 1; i < static_cast<size_t>(Action::Count); ++i) {
+        if (name == kActionNames[i]) {
+            return static_cast<Action>(i);
+        }
+    }
+    return Action::None;
+}
+
 void KeyMapper::LoadMappings(const std::map<std::string, std::string>& mappings) {
-    m_keyMappings.clear();
+    m_table.fill(Action::None);
     for (const auto& pair : mappings) {
         // Convert string key name to SDL_Scancode
         SDL_Scancode scancode = SDL_GetScancodeFromName(pair.first.c_str());
         if (scancode != SDL_SCANCODE_UNKNOWN) {
-            m_keyMappings[scancode] = pair.second;
+            MapKey(scancode, pair.second);
         }
     }
 }
 
 std::map<std::string, std::string> KeyMapper::GetMappings() const {
     std::map<std::string, std::string> result;
-    for (const auto& pair : m_keyMappings) {
-        result[GetKeyName(pair.first)] = pair.second;
+    for (size_t i = 0; i < kScancodeCount; ++i) {
+        if (m_table[i] != Action::None) {
+            result[GetKeyName(static_cast<SDL_Scancode>(i))] = GetActionName(m_table[i]);
+        }
     }
     return result;
 }
 
 void KeyMapper::SetDefaultMappings() {
-    m_keyMappings.clear();
+    m_table.fill(Action::None);
     
     // Default key mappings
-    m_keyMappings[SDL_SCANCODE_ESCAPE] = "quit";
-    m_keyMappings[SDL_SCANCODE_F1] = "toggle_debug";
-    m_keyMappings[SDL_SCANCODE_F2] = "toggle_about";
-    m_keyMappings[SDL_SCANCODE_F3] = "toggle_menu";
-    m_keyMappings[SDL_SCANCODE_F11] = "toggle_fullscreen";
+    MapKey(SDL_SCANCODE_ESCAPE, Action::Quit);
+    MapKey(SDL_SCANCODE_F1, Action::ToggleDebug);
+    MapKey(SDL_SCANCODE_F2, Action::ToggleAbout);
+    MapKey(SDL_SCANCODE_F3, Action::ToggleMenu);
+    MapKey(SDL_SCANCODE_F4, Action::DumpTelemetry);
+    MapKey(SDL_SCANCODE_F5, Action::ToggleTestPattern);
+    MapKey(SDL_SCANCODE_F6, Action::DumpProfile);
+    MapKey(SDL_SCANCODE_F11, Action::ToggleFullscreen);
+    
+    // Guest keys (only while the main menu is closed; the menu uses the arrows itself)
+    MapKey(SDL_SCANCODE_UP, Action::GuestUp);
+    MapKey(SDL_SCANCODE_DOWN, Action::GuestDown);
+    MapKey(SDL_SCANCODE_LEFT, Action::GuestLeft);
+    MapKey(SDL_SCANCODE_RIGHT, Action::GuestRight);
+    MapKey(SDL_SCANCODE_RETURN, Action::GuestSelect);
+    MapKey(SDL_SCANCODE_BACKSPACE, Action::GuestBack);
+    MapKey(SDL_SCANCODE_HOME, Action::GuestHome);
+    MapKey(SDL_SCANCODE_APPLICATION, Action::GuestMenu);
 }
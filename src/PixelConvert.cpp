@@ -0,0 +1,318 @@
+#include "PixelConvert.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXEL_CONVERT_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define PIXEL_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+// The AVX2 kernels are compiled for AVX2 on their own and only called after
+// the CPU check, so the rest of the program still runs on any x86-64 CPU
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXEL_CONVERT_AVX2 __attribute__((target("avx2")))
+#else
+#define PIXEL_CONVERT_AVX2
+#endif
+
+namespace {
+
+using ConvertFunction = void (*)(const uint8_t* src, uint32_t* dst, size_t pixels);
+using ScaleFunction = void (*)(const uint32_t* src, uint32_t* dst, size_t pixels);
+
+// RGB565 expands to 8 bits per channel by repeating the top bits, so full
+// intensity maps to 255 rather than 248/252
+void ConvertRGB565Scalar(const uint8_t* src, uint32_t* dst, size_t pixels) {
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+    for (size_t i = 0; i < pixels; ++i) {
+        uint32_t v = static_cast<uint32_t>(src[2 * i]) | (static_cast<uint32_t>(src[2 * i + 1]) << 8);
+        out[4 * i + 0] = static_cast<uint8_t>(((v >> 8) & 0xF8) | (v >> 13));
+        out[4 * i + 1] = static_cast<uint8_t>(((v >> 3) & 0xFC) | ((v >> 9) & 0x03));
+        out[4 * i + 2] = static_cast<uint8_t>(((v << 3) & 0xF8) | ((v >> 2) & 0x07));
+        out[4 * i + 3] = 0xFF;
+    }
+}
+
+void ConvertBGRAScalar(const uint8_t* src, uint32_t* dst, size_t pixels) {
+    uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+    for (size_t i = 0; i < pixels; ++i) {
+        out[4 * i + 0] = src[4 * i + 2];
+        out[4 * i + 1] = src[4 * i + 1];
+        out[4 * i + 2] = src[4 * i + 0];
+        out[4 * i + 3] = src[4 * i + 3];
+    }
+}
+
+void ScaleRow2xScalar(const uint32_t* src, uint32_t* dst, size_t pixels) {
+    for (size_t i = 0; i < pixels; ++i) {
+        dst[2 * i] = src[i];
+        dst[2 * i + 1] = src[i];
+    }
+}
+
+#if defined(PIXEL_CONVERT_X86)
+
+void ConvertRGB565SSE2(const uint8_t* src, uint32_t* dst, size_t pixels) {
+    const __m128i mask5 = _mm_set1_epi16(0xF8);
+    const __m128i mask6 = _mm_set1_epi16(0xFC);
+    const __m128i low2 = _mm_set1_epi16(0x03);
+    const __m128i low3 = _mm_set1_epi16(0x07);
+    const __m128i alpha = _mm_set1_epi16(static_cast<short>(0xFF00));
+
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+        __m128i r = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 8), mask5), _mm_srli_epi16(v, 13));
+        __m128i g = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 3), mask6), _mm_and_si128(_mm_srli_epi16(v, 9), low2));
+        __m128i b = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 3), mask5), _mm_and_si128(_mm_srli_epi16(v, 2), low3));
+
+        // 16-bit lanes R|G<<8 and B|A<<8 interleave into RGBA pixels
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        __m128i ba = _mm_or_si128(b, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(rg, ba));
+    }
+    ConvertRGB565Scalar(src + 2 * i, dst + i, pixels - i);
+}
+
+void ConvertBGRASSE2(const uint8_t* src, uint32_t* dst, size_t pixels) {
+    const __m128i maskGA = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+    const __m128i maskBR = _mm_set1_epi32(0x00FF00FF);
+
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+        // B and R sit in the low bytes of the two 16-bit halves; swap the halves
+        __m128i br = _mm_and_si128(v, maskBR);
+        br = _mm_shufflehi_epi16(_mm_shufflelo_epi16(br, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(_mm_and_si128(v, maskGA), br));
+    }
+    ConvertBGRAScalar(src + 4 * i, dst + i, pixels - i);
+}
+
+void ScaleRow2xSSE2(const uint32_t* src, uint32_t* dst, size_t pixels) {
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_unpacklo_epi32(v, v));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 4), _mm_unpackhi_epi32(v, v));
+    }
+    ScaleRow2xScalar(src + i, dst + 2 * i, pixels - i);
+}
+
+PIXEL_CONVERT_AVX2 void ConvertRGB565AVX2(const uint8_t* src, uint32_t* dst, size_t pixels) {
+    const __m256i mask5 = _mm256_set1_epi16(0xF8);
+    const __m256i mask6 = _mm256_set1_epi16(0xFC);
+    const __m256i low2 = _mm256_set1_epi16(0x03);
+    const __m256i low3 = _mm256_set1_epi16(0x07);
+    const __m256i alpha = _mm256_set1_epi16(static_cast<short>(0xFF00));
+
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i));
+        __m256i r = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(v, 8), mask5), _mm256_srli_epi16(v, 13));
+        __m256i g = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(v, 3), mask6),
+                                    _mm256_and_si256(_mm256_srli_epi16(v, 9), low2));
+        __m256i b = _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi16(v, 3), mask5),
+                                    _mm256_and_si256(_mm256_srli_epi16(v, 2), low3));
+        __m256i rg = _mm256_or_si256(r, _mm256_slli_epi16(g, 8));
+        __m256i ba = _mm256_or_si256(b, alpha);
+
+        // Unpacking works per 128-bit lane (pixels 0-3 | 8-11 and 4-7 | 12-15); restore the order
+        __m256i lo = _mm256_unpacklo_epi16(rg, ba);
+        __m256i hi = _mm256_unpackhi_epi16(rg, ba);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    ConvertRGB565SSE2(src + 2 * i, dst + i, pixels - i);
+}
+
+PIXEL_CONVERT_AVX2 void ConvertBGRAAVX2(const uint8_t* src, uint32_t* dst, size_t pixels) {
+    const __m256i swap = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                          2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(v, swap));
+    }
+    ConvertBGRASSE2(src + 4 * i, dst + i, pixels - i);
+}
+
+#elif defined(PIXEL_CONVERT_NEON)
+
+void ConvertRGB565NEON(const uint8_t* src, uint32_t* dst, size_t pixels) {
+    const uint16x8_t mask5 = vdupq_n_u16(0xF8);
+    const uint16x8_t mask6 = vdupq_n_u16(0xFC);
+    const uint16x8_t low2 = vdupq_n_u16(0x03);
+    const uint16x8_t low3 = vdupq_n_u16(0x07);
+
+    size_t i = 0;
+    for (; i + 8 <= pixels; i += 8) {
+        uint16x8_t v = vreinterpretq_u16_u8(vld1q_u8(src + 2 * i));
+        uint8x8x4_t out;
+        out.val[0] = vmovn_u16(vorrq_u16(vandq_u16(vshrq_n_u16(v, 8), mask5), vshrq_n_u16(v, 13)));
+        out.val[1] = vmovn_u16(vorrq_u16(vandq_u16(vshrq_n_u16(v, 3), mask6), vandq_u16(vshrq_n_u16(v, 9), low2)));
+        out.val[2] = vmovn_u16(vorrq_u16(vandq_u16(vshlq_n_u16(v, 3), mask5), vandq_u16(vshrq_n_u16(v, 2), low3)));
+        out.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), out);
+    }
+    ConvertRGB565Scalar(src + 2 * i, dst + i, pixels - i);
+}
+
+void ConvertBGRANEON(const uint8_t* src, uint32_t* dst, size_t pixels) {
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x4_t v = vld4q_u8(src + 4 * i);
+        uint8x16_t blue = v.val[0];
+        v.val[0] = v.val[2];
+        v.val[2] = blue;
+        vst4q_u8(reinterpret_cast<uint8_t*>(dst + i), v);
+    }
+    ConvertBGRAScalar(src + 4 * i, dst + i, pixels - i);
+}
+
+void ScaleRow2xNEON(const uint32_t* src, uint32_t* dst, size_t pixels) {
+    size_t i = 0;
+    for (; i + 4 <= pixels; i += 4) {
+        uint32x4_t v = vld1q_u32(src + i);
+        uint32x4x2_t pairs = vzipq_u32(v, v);
+        vst1q_u32(dst + 2 * i, pairs.val[0]);
+        vst1q_u32(dst + 2 * i + 4, pairs.val[1]);
+    }
+    ScaleRow2xScalar(src + i, dst + 2 * i, pixels - i);
+}
+
+#endif
+
+SimdLevel DetectSimdLevel() {
+#if defined(PIXEL_CONVERT_X86)
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+#elif defined(_MSC_VER)
+    // AVX2 needs the CPU feature and the OS saving YMM state (OSXSAVE + XCR0)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5)) {
+                return SimdLevel::AVX2;
+            }
+        }
+    }
+#endif
+    return SimdLevel::SSE2;
+#elif defined(PIXEL_CONVERT_NEON)
+    return SimdLevel::NEON;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+struct Kernels {
+    SimdLevel level;
+    ConvertFunction rgb565;
+    ConvertFunction bgra;
+    ScaleFunction scale2x;
+};
+
+Kernels SelectKernels(SimdLevel level) {
+    switch (level) {
+#if defined(PIXEL_CONVERT_X86)
+        case SimdLevel::AVX2:
+            return {SimdLevel::AVX2, ConvertRGB565AVX2, ConvertBGRAAVX2, ScaleRow2xSSE2};
+        case SimdLevel::SSE2:
+            return {SimdLevel::SSE2, ConvertRGB565SSE2, ConvertBGRASSE2, ScaleRow2xSSE2};
+#elif defined(PIXEL_CONVERT_NEON)
+        case SimdLevel::NEON:
+            return {SimdLevel::NEON, ConvertRGB565NEON, ConvertBGRANEON, ScaleRow2xNEON};
+#endif
+        default:
+            return {SimdLevel::Scalar, ConvertRGB565Scalar, ConvertBGRAScalar, ScaleRow2xScalar};
+    }
+}
+
+const SimdLevel g_supportedLevel = DetectSimdLevel();
+Kernels g_kernels = SelectKernels(g_supportedLevel);
+
+} // namespace
+
+int PixelConvert::GetBytesPerPixel(GuestPixelFormat format) {
+    return format == GuestPixelFormat::RGB565 ? 2 : 4;
+}
+
+const char* PixelConvert::GetFormatName(GuestPixelFormat format) {
+    switch (format) {
+        case GuestPixelFormat::RGB565: return "RGB565";
+        case GuestPixelFormat::BGRA8888: return "BGRA8888";
+        case GuestPixelFormat::RGBA8888: return "RGBA8888";
+    }
+    return "unknown";
+}
+
+void PixelConvert::ConvertRow(GuestPixelFormat format, const void* src, uint32_t* dst, size_t pixels) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(src);
+    switch (format) {
+        case GuestPixelFormat::RGB565:
+            g_kernels.rgb565(bytes, dst, pixels);
+            break;
+        case GuestPixelFormat::BGRA8888:
+            g_kernels.bgra(bytes, dst, pixels);
+            break;
+        case GuestPixelFormat::RGBA8888:
+            std::memcpy(dst, bytes, pixels * 4);
+            break;
+    }
+}
+
+void PixelConvert::ScaleRow(const uint32_t* src, uint32_t* dst, size_t pixels, int factor) {
+    if (factor == 1) {
+        std::memcpy(dst, src, pixels * 4);
+    } else if (factor == 2) {
+        g_kernels.scale2x(src, dst, pixels);
+    } else {
+        for (size_t i = 0; i < pixels; ++i) {
+            std::fill_n(dst + i * factor, factor, src[i]);
+        }
+    }
+}
+
+SimdLevel PixelConvert::GetSimdLevel() {
+    return g_kernels.level;
+}
+
+SimdLevel PixelConvert::GetSupportedSimdLevel() {
+    return g_supportedLevel;
+}
+
+void PixelConvert::ForceSimdLevel(SimdLevel level) {
+    // Levels are ordered within an architecture; NEON never coexists with SSE2/AVX2
+    if (level == SimdLevel::NEON || g_supportedLevel == SimdLevel::NEON) {
+        level = level == g_supportedLevel ? level : SimdLevel::Scalar;
+    } else {
+        level = std::min(level, g_supportedLevel);
+    }
+    g_kernels = SelectKernels(level);
+}
+
+const char* PixelConvert::GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE2: return "SSE2";
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::NEON: return "NEON";
+    }
+    return "unknown";
+}
@@ -0,0 +1,198 @@
+#include "Profiler.h"
+#include <iostream>
+
+#ifdef EMULATOR_PROFILER
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Per-thread history: 32768 zones (768 KB), about half a minute of frames
+constexpr uint64_t kZoneCapacity = 1 << 15;
+
+const Clock::time_point g_start = Clock::now();
+
+// Fields are atomics so WriteTrace can copy a slot while its thread
+// overwrites it; the copy is then dropped (see WriteTrace)
+struct Zone {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> begin{0};
+    std::atomic<uint64_t> end{0};
+};
+
+struct ThreadBuffer {
+    Zone zones[kZoneCapacity];
+    std::atomic<uint64_t> head{0};     // Zones recorded so far; the next one goes to head % capacity
+    std::atomic<uint64_t> floor{0};    // Zones below this belong to the buffer's previous thread
+    std::string threadName;            // Guarded by g_mutex
+    bool inUse = false;                // Guarded by g_mutex
+};
+
+// Buffers outlive their threads so a dump still shows a finished scan.
+// A new thread takes over the buffer of one that has exited.
+std::mutex g_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+
+ThreadBuffer* AcquireBuffer() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : g_buffers) {
+        if (!buffer->inUse) {
+            buffer->inUse = true;
+            buffer->threadName.clear();
+            buffer->floor.store(buffer->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return buffer.get();
+        }
+    }
+    g_buffers.push_back(std::make_unique<ThreadBuffer>());
+    g_buffers.back()->inUse = true;
+    return g_buffers.back().get();
+}
+
+// Hands the buffer back when its thread exits
+struct ThreadSlot {
+    ThreadBuffer* buffer = nullptr;
+
+    ~ThreadSlot() {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            buffer->inUse = false;
+        }
+    }
+};
+
+thread_local ThreadSlot t_slot;
+
+ThreadBuffer& GetThreadBuffer() {
+    if (!t_slot.buffer) {
+        t_slot.buffer = AcquireBuffer();
+    }
+    return *t_slot.buffer;
+}
+
+struct ZoneCopy {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+} // namespace
+
+bool Profiler::IsEnabled() {
+    return true;
+}
+
+uint64_t Profiler::Now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - g_start).count());
+}
+
+void Profiler::Record(const char* name, uint64_t beginNanos, uint64_t endNanos) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    Zone& zone = buffer.zones[head % kZoneCapacity];
+    // A reader that sees any of the stores below also sees head >= this
+    // zone's index, which tells it the slot was being overwritten
+    std::atomic_thread_fence(std::memory_order_release);
+    zone.name.store(name, std::memory_order_relaxed);
+    zone.begin.store(beginNanos, std::memory_order_relaxed);
+    zone.end.store(endNanos, std::memory_order_relaxed);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const char* name) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    buffer.threadName = name;
+}
+
+bool Profiler::WriteTrace(const std::string& filepath) {
+    FILE* file = std::fopen(filepath.c_str(), "w");
+    if (!file) {
+        std::cerr << "Error: Could not write profiler trace to " << filepath << std::endl;
+        return false;
+    }
+
+    // Holding the lock only keeps threads from starting or exiting; recording goes on
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::vector<ZoneCopy> copies;
+    copies.reserve(kZoneCapacity);
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    bool first = true;
+    size_t zoneCount = 0;
+    for (size_t i = 0; i < g_buffers.size(); ++i) {
+        ThreadBuffer& buffer = *g_buffers[i];
+        size_t thread = i + 1;
+        if (!buffer.threadName.empty()) {
+            std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"%s\"}}",
+                         first ? "" : ",\n", thread, buffer.threadName.c_str());
+            first = false;
+        }
+
+        uint64_t head = buffer.head.load(std::memory_order_acquire);
+        uint64_t start = head > kZoneCapacity ? head - kZoneCapacity : 0;
+        start = std::max(start, buffer.floor.load(std::memory_order_relaxed));
+        copies.clear();
+        for (uint64_t index = start; index < head; ++index) {
+            const Zone& zone = buffer.zones[index % kZoneCapacity];
+            copies.push_back({zone.name.load(std::memory_order_relaxed), zone.begin.load(std::memory_order_relaxed),
+                              zone.end.load(std::memory_order_relaxed)});
+        }
+        // Slots the thread got to while they were copied are torn: drop them
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t newHead = buffer.head.load(std::memory_order_relaxed);
+        size_t skip = 0;
+        if (newHead > kZoneCapacity && newHead - kZoneCapacity >= start) {
+            skip = static_cast<size_t>(std::min<uint64_t>(newHead - kZoneCapacity + 1 - start, copies.size()));
+        }
+
+        for (size_t c = skip; c < copies.size(); ++c) {
+            const ZoneCopy& zone = copies[c];
+            std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%" PRIu64 ".%03u,\"dur\":%" PRIu64 ".%03u}",
+                         first ? "" : ",\n", zone.name, thread,
+                         zone.begin / 1000, static_cast<unsigned>(zone.begin % 1000),
+                         (zone.end - zone.begin) / 1000, static_cast<unsigned>((zone.end - zone.begin) % 1000));
+            first = false;
+        }
+        zoneCount += copies.size() - skip;
+    }
+    std::fputs("\n]}\n", file);
+
+    if (std::fclose(file) != 0) {
+        std::cerr << "Error: Could not write profiler trace to " << filepath << std::endl;
+        return false;
+    }
+    std::cout << "Profiler trace: " << zoneCount << " zones from " << g_buffers.size() << " threads written to "
+              << filepath << std::endl;
+    return true;
+}
+
+#else
+
+bool Profiler::IsEnabled() {
+    return false;
+}
+
+uint64_t Profiler::Now() {
+    return 0;
+}
+
+void Profiler::Record(const char*, uint64_t, uint64_t) {
+}
+
+void Profiler::SetThreadName(const char*) {
+}
+
+bool Profiler::WriteTrace(const std::string&) {
+    std::cerr << "Error: Profiler not built in (configure with -DEMULATOR_PROFILER=ON)" << std::endl;
+    return false;
+}
+
+#endif
@@ -0,0 +1,175 @@
+#include "ResStringPool.h"
+#include "ByteReader.h"
+
+namespace {
+
+constexpr uint16_t kStringPoolType = 0x0001;
+constexpr size_t kStringPoolHeaderSize = 28;
+constexpr uint32_t kUTF8Flag = 1u << 8;
+
+void AppendUTF8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    }
+    else if (cp < 0x800) {
+        out += static_cast<char>(0xc0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else if (cp < 0x10000) {
+        out += static_cast<char>(0xe0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else {
+        out += static_cast<char>(0xf0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+}
+
+} // namespace
+
+ResStringPool::ResStringPool()
+    : m_offsets(nullptr)
+    , m_strings(nullptr)
+    , m_stringsSize(0)
+    , m_count(0)
+    , m_utf8(false)
+{
+}
+
+bool ResStringPool::Init(const uint8_t* chunk, size_t size) {
+    m_count = 0;
+    if (size < kStringPoolHeaderSize || ReadLE16(chunk) != kStringPoolType) {
+        return false;
+    }
+
+    uint16_t headerSize = ReadLE16(chunk + 2);
+    uint32_t chunkSize = ReadLE32(chunk + 4);
+    uint32_t stringCount = ReadLE32(chunk + 8);
+    uint32_t flags = ReadLE32(chunk + 16);
+    uint32_t stringsStart = ReadLE32(chunk + 20);
+    uint32_t stylesStart = ReadLE32(chunk + 24);
+
+    if (chunkSize > size || headerSize < kStringPoolHeaderSize || headerSize > chunkSize) {
+        return false;
+    }
+    if (stringCount > (chunkSize - headerSize) / 4) {
+        return false;
+    }
+    if (stringCount > 0 && (stringsStart < headerSize + stringCount * 4 || stringsStart > chunkSize)) {
+        return false;
+    }
+
+    // Strings end where styles begin, or at the end of the chunk
+    uint32_t stringsEnd = (stylesStart > stringsStart && stylesStart <= chunkSize) ? stylesStart : chunkSize;
+
+    m_offsets = chunk + headerSize;
+    m_strings = chunk + stringsStart;
+    m_stringsSize = stringsEnd - stringsStart;
+    m_count = stringCount;
+    m_utf8 = (flags & kUTF8Flag) != 0;
+    return true;
+}
+
+bool ResStringPool::Locate(uint32_t index, const uint8_t*& data, size_t& units) const {
+    if (index >= m_count) {
+        return false;
+    }
+
+    size_t offset = ReadLE32(m_offsets + index * 4);
+    const uint8_t* end = m_strings + m_stringsSize;
+    const uint8_t* p = m_strings + offset;
+    if (offset >= m_stringsSize) {
+        return false;
+    }
+
+    if (m_utf8) {
+        // UTF-16 length then UTF-8 length, each 1 or 2 bytes
+        for (int i = 0; i < 2; ++i) {
+            if (end - p < 1) return false;
+            size_t len = *p++;
+            if (len & 0x80) {
+                if (end - p < 1) return false;
+                len = ((len & 0x7f) << 8) | *p++;
+            }
+            units = len;
+        }
+        if (static_cast<size_t>(end - p) < units) {
+            return false;
+        }
+    }
+    else {
+        if (end - p < 2) return false;
+        size_t len = ReadLE16(p);
+        p += 2;
+        if (len & 0x8000) {
+            if (end - p < 2) return false;
+            len = ((len & 0x7fff) << 16) | ReadLE16(p);
+            p += 2;
+        }
+        units = len;
+        if (static_cast<size_t>(end - p) / 2 < units) {
+            return false;
+        }
+    }
+
+    data = p;
+    return true;
+}
+
+bool ResStringPool::Equals(uint32_t index, std::string_view ascii) const {
+    const uint8_t* data = nullptr;
+    size_t units = 0;
+    if (!Locate(index, data, units) || units != ascii.size()) {
+        return false;
+    }
+
+    if (m_utf8) {
+        return std::string_view(reinterpret_cast<const char*>(data), units) == ascii;
+    }
+    for (size_t i = 0; i < units; ++i) {
+        if (ReadLE16(data + i * 2) != static_cast<uint8_t>(ascii[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ResStringPool::GetView(uint32_t index, std::string_view& out) const {
+    const uint8_t* data = nullptr;
+    size_t units = 0;
+    if (!m_utf8 || !Locate(index, data, units)) {
+        return false;
+    }
+    out = std::string_view(reinterpret_cast<const char*>(data), units);
+    return true;
+}
+
+std::string ResStringPool::Get(uint32_t index) const {
+    const uint8_t* data = nullptr;
+    size_t units = 0;
+    if (!Locate(index, data, units)) {
+        return std::string();
+    }
+
+    if (m_utf8) {
+        return std::string(reinterpret_cast<const char*>(data), units);
+    }
+
+    std::string out;
+    out.reserve(units);
+    for (size_t i = 0; i < units; ++i) {
+        uint32_t cp = ReadLE16(data + i * 2);
+        if (cp >= 0xd800 && cp < 0xdc00 && i + 1 < units) {
+            uint32_t low = ReadLE16(data + (i + 1) * 2);
+            if (low >= 0xdc00 && low < 0xe000) {
+                cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                ++i;
+            }
+        }
+        AppendUTF8(out, cp);
+    }
+    return out;
+}
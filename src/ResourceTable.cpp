@@ -0,0 +1,225 @@
+#include "ResourceTable.h"
+#include "ByteReader.h"
+#include "ResStringPool.h"
+
+namespace {
+
+constexpr uint16_t kChunkStringPool = 0x0001;
+constexpr uint16_t kChunkTable = 0x0002;
+constexpr uint16_t kChunkTablePackage = 0x0200;
+constexpr uint16_t kChunkTableType = 0x0201;
+
+constexpr uint8_t kTypeFlagSparse = 0x01;
+constexpr uint8_t kTypeFlagOffset16 = 0x02;
+constexpr uint16_t kEntryFlagComplex = 0x0001;
+constexpr uint16_t kEntryFlagCompact = 0x0008;
+
+constexpr uint8_t kTypeReference = 0x01;
+constexpr uint8_t kTypeString = 0x03;
+
+constexpr int kMaxReferenceHops = 4;
+
+// Better configs score higher: the all-zero default config wins,
+// then anything without a locale, then whatever comes first
+int ScoreConfig(const uint8_t* config, size_t available) {
+    uint32_t configSize = ReadLE32(config);
+    if (configSize > available || configSize < 12) {
+        return 0;
+    }
+    bool allZero = true;
+    for (size_t i = 4; i < configSize; ++i) {
+        if (config[i] != 0) {
+            allZero = false;
+            break;
+        }
+    }
+    if (allZero) {
+        return 3;
+    }
+    bool noLocale = ReadLE32(config + 8) == 0;
+    return noLocale ? 2 : 1;
+}
+
+// Value of entry 'entryIndex' in one ResTable_type chunk
+bool ReadTypeEntry(const uint8_t* chunk, uint32_t chunkSize, uint32_t entryIndex, uint8_t& type, uint32_t& value) {
+    uint16_t headerSize = ReadLE16(chunk + 2);
+    uint8_t flags = chunk[9];
+    uint32_t entryCount = ReadLE32(chunk + 12);
+    uint32_t entriesStart = ReadLE32(chunk + 16);
+    if (entriesStart > chunkSize || headerSize > entriesStart) {
+        return false;
+    }
+
+    const uint8_t* offsets = chunk + headerSize;
+    size_t offsetsSize = entriesStart - headerSize;
+    uint32_t offset = 0;
+
+    if (flags & kTypeFlagSparse) {
+        // Sorted (index, offset / 4) pairs
+        if (offsetsSize / 4 < entryCount) {
+            return false;
+        }
+        uint32_t lo = 0;
+        uint32_t hi = entryCount;
+        bool found = false;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            uint16_t idx = ReadLE16(offsets + mid * 4);
+            if (idx == entryIndex) {
+                offset = static_cast<uint32_t>(ReadLE16(offsets + mid * 4 + 2)) * 4;
+                found = true;
+                break;
+            }
+            if (idx < entryIndex) lo = mid + 1;
+            else hi = mid;
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    else if (flags & kTypeFlagOffset16) {
+        if (entryIndex >= entryCount || offsetsSize / 2 < entryCount) {
+            return false;
+        }
+        uint16_t off16 = ReadLE16(offsets + entryIndex * 2);
+        if (off16 == 0xffff) {
+            return false;
+        }
+        offset = static_cast<uint32_t>(off16) * 4;
+    }
+    else {
+        if (entryIndex >= entryCount || offsetsSize / 4 < entryCount) {
+            return false;
+        }
+        offset = ReadLE32(offsets + entryIndex * 4);
+        if (offset == 0xffffffffu) {
+            return false;
+        }
+    }
+
+    if (offset > chunkSize - entriesStart || chunkSize - entriesStart - offset < 8) {
+        return false;
+    }
+    const uint8_t* entry = chunk + entriesStart + offset;
+    uint16_t entrySize = ReadLE16(entry);
+    uint16_t entryFlags = ReadLE16(entry + 2);
+
+    if (entryFlags & kEntryFlagCompact) {
+        // Compact entries inline the value: type in the high flag byte, data in place of the key
+        type = static_cast<uint8_t>(entryFlags >> 8);
+        value = ReadLE32(entry + 4);
+        return true;
+    }
+    if (entryFlags & kEntryFlagComplex) {
+        return false;
+    }
+
+    size_t remaining = chunkSize - entriesStart - offset;
+    if (entrySize < 8 || remaining < static_cast<size_t>(entrySize) + 8) {
+        return false;
+    }
+    const uint8_t* resValue = entry + entrySize;
+    type = resValue[3];
+    value = ReadLE32(resValue + 4);
+    return true;
+}
+
+// Searches one package chunk for the best-config value of (typeId, entryIndex)
+bool FindInPackage(const uint8_t* pkg, uint32_t pkgSize, uint8_t typeId, uint32_t entryIndex,
+                   uint8_t& type, uint32_t& value) {
+    uint16_t headerSize = ReadLE16(pkg + 2);
+    int bestScore = 0;
+    size_t pos = headerSize;
+
+    while (pos + 8 <= pkgSize) {
+        const uint8_t* chunk = pkg + pos;
+        uint16_t chunkType = ReadLE16(chunk);
+        uint32_t chunkSize = ReadLE32(chunk + 4);
+        if (chunkSize < 8 || chunkSize > pkgSize - pos) {
+            break;
+        }
+
+        if (chunkType == kChunkTableType && chunkSize >= 24 && chunk[8] == typeId) {
+            // The config sits between byte 20 and the end of the header; a header
+            // reaching outside its chunk is damaged (or crafted), so skip the chunk
+            uint16_t typeHeaderSize = ReadLE16(chunk + 2);
+            if (typeHeaderSize < 20 || typeHeaderSize > chunkSize) {
+                pos += chunkSize;
+                continue;
+            }
+            int score = typeHeaderSize > 20 ? ScoreConfig(chunk + 20, typeHeaderSize - 20) : 0;
+            uint8_t candidateType = 0;
+            uint32_t candidateValue = 0;
+            if (score > bestScore && ReadTypeEntry(chunk, chunkSize, entryIndex, candidateType, candidateValue)) {
+                bestScore = score;
+                type = candidateType;
+                value = candidateValue;
+                if (score == 3) {
+                    return true;
+                }
+            }
+        }
+        pos += chunkSize;
+    }
+    return bestScore > 0;
+}
+
+} // namespace
+
+bool ResourceTable::ResolveString(const uint8_t* data, size_t size, uint32_t resId, std::string& out) {
+    if (size < 12 || ReadLE16(data) != kChunkTable) {
+        return false;
+    }
+    uint16_t tableHeaderSize = ReadLE16(data + 2);
+    uint32_t tableSize = ReadLE32(data + 4);
+    if (tableSize < size) {
+        size = tableSize;
+    }
+
+    ResStringPool globalStrings;
+    bool havePool = false;
+
+    for (int hop = 0; hop < kMaxReferenceHops; ++hop) {
+        uint8_t packageId = static_cast<uint8_t>(resId >> 24);
+        uint8_t typeId = static_cast<uint8_t>(resId >> 16);
+        uint32_t entryIndex = resId & 0xffff;
+
+        uint8_t type = 0;
+        uint32_t value = 0;
+        bool found = false;
+
+        size_t pos = tableHeaderSize;
+        while (!found && pos + 8 <= size) {
+            const uint8_t* chunk = data + pos;
+            uint16_t chunkType = ReadLE16(chunk);
+            uint32_t chunkSize = ReadLE32(chunk + 4);
+            if (chunkSize < 8 || chunkSize > size - pos) {
+                break;
+            }
+
+            if (chunkType == kChunkStringPool && !havePool) {
+                havePool = globalStrings.Init(chunk, chunkSize);
+            }
+            else if (chunkType == kChunkTablePackage && chunkSize >= 12 && ReadLE32(chunk + 8) == packageId) {
+                found = FindInPackage(chunk, chunkSize, typeId, entryIndex, type, value);
+            }
+            pos += chunkSize;
+        }
+
+        if (!found) {
+            return false;
+        }
+        if (type == kTypeString) {
+            if (!havePool) {
+                return false;
+            }
+            out = globalStrings.Get(value);
+            return true;
+        }
+        if (type != kTypeReference) {
+            return false;
+        }
+        resId = value;
+    }
+    return false;
+}
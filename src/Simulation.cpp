@@ -0,0 +1,208 @@
+#include "Simulation.h"
+#include "Profiler.h"
+#include <algorithm>
+
+Simulation::Simulation(int tickRate)
+    : m_tickSeconds(1.0 / std::max(1, tickRate))
+    , m_stopping(false)
+    , m_inputPending(false)
+    , m_droppedInputs(0)
+    , m_droppedTicks(0)
+    , m_configWatcher(nullptr)
+    , m_configReader(-1)
+    , m_configGeneration(0)
+{
+}
+
+Simulation::~Simulation() {
+    Stop();
+}
+
+void Simulation::Start() {
+    if (m_thread.joinable()) {
+        return;
+    }
+    m_stopping = false;
+    m_thread = std::thread(&Simulation::ThreadLoop, this);
+}
+
+void Simulation::Stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void Simulation::SetConfigSource(ConfigWatcher* watcher) {
+    m_configWatcher = watcher;
+    m_configReader = watcher ? watcher->RegisterReader() : -1;
+    if (m_configReader < 0) {
+        m_configWatcher = nullptr;
+    }
+}
+
+bool Simulation::PushInput(const InputEvent& event) {
+    if (!m_input.TryPush(event)) {
+        ++m_droppedInputs;
+        return false;
+    }
+    // Taking the mutex orders the flag against the thread's check before it
+    // waits, so the notification cannot slip in between and get lost
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_inputPending.store(true, std::memory_order_relaxed);
+    }
+    m_wake.notify_one();
+    return true;
+}
+
+bool Simulation::DrainInput() {
+    auto now = std::chrono::steady_clock::now();
+    bool any = false;
+    InputEvent event;
+    while (m_input.TryPop(event)) {
+        uint32_t button = KeyMapper::GetGuestButton(event.action);
+        if (event.pressed) {
+            m_state.buttons |= button;
+        } else {
+            m_state.buttons &= ~button;
+        }
+        ++m_state.inputEvents;
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - event.timestamp).count();
+        m_inputLatency.Record(static_cast<uint64_t>(std::max<int64_t>(latency, 0)));
+        any = true;
+    }
+
+    if (any) {
+        m_inputLatencyStats.events = m_inputLatency.GetCount();
+        m_inputLatencyStats.p50Micros = static_cast<uint32_t>(m_inputLatency.GetPercentile(0.50));
+        m_inputLatencyStats.p99Micros = static_cast<uint32_t>(m_inputLatency.GetPercentile(0.99));
+        m_inputLatencyStats.maxMicros = static_cast<uint32_t>(m_inputLatency.GetMax());
+    }
+    return any;
+}
+
+const SimulationSnapshot& Simulation::AcquireSnapshot() {
+    m_snapshots.Update();
+    return m_snapshots.GetReadBuffer();
+}
+
+double Simulation::GetInterpolationAlpha(const SimulationSnapshot& snapshot,
+                                         std::chrono::steady_clock::time_point now) {
+    if (snapshot.tickSeconds <= 0.0) {
+        return 1.0;
+    }
+    double sinceTick = std::chrono::duration<double>(now - snapshot.currentAt).count();
+    return std::clamp(sinceTick / snapshot.tickSeconds, 0.0, 1.0);
+}
+
+SimulationState Simulation::Interpolate(const SimulationSnapshot& snapshot, double alpha) {
+    // Discrete fields come from the newest tick; continuous ones are blended
+    SimulationState state = snapshot.current;
+    state.time = snapshot.previous.time + (snapshot.current.time - snapshot.previous.time) * alpha;
+    return state;
+}
+
+void Simulation::Advance(int ticks) {
+    if (m_thread.joinable()) {
+        return;
+    }
+    DrainInput();
+    for (int i = 0; i < ticks; ++i) {
+        m_previousState = m_state;
+        Step(m_tickSeconds);
+    }
+    m_lastTickAt = std::chrono::steady_clock::now();
+    PublishSnapshot(m_lastTickAt);
+}
+
+void Simulation::ThreadLoop() {
+    Profiler::SetThreadName("simulation");
+    using Clock = std::chrono::steady_clock;
+    auto tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_tickSeconds));
+
+    auto nextTick = Clock::now();
+    m_lastTickAt = nextTick;
+    PublishSnapshot(m_lastTickAt);
+
+    while (!m_stopping) {
+        // A new tick rate starts with the next tick; ticks already due keep their times
+        if (ApplyConfig()) {
+            tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_tickSeconds));
+        }
+
+        // Input first, so a tick that is due already sees it
+        m_inputPending.store(false, std::memory_order_relaxed);
+        bool inputChanged = DrainInput();
+        auto now = Clock::now();
+
+        // Consume the elapsed real time in whole ticks
+        int ticks = 0;
+        while (nextTick <= now && ticks < kMaxTicksPerUpdate) {
+            m_previousState = m_state;
+            Step(m_tickSeconds);
+            nextTick += tick;
+            ++ticks;
+        }
+        if (nextTick <= now) {
+            // Too far behind (debugger, suspended laptop): drop the backlog
+            // instead of fast-forwarding through it
+            auto behind = now - nextTick;
+            m_droppedTicks += static_cast<uint64_t>(behind / tick) + 1;
+            nextTick = now + tick;
+        }
+
+        if (ticks > 0) {
+            m_lastTickAt = Clock::now();
+            PublishSnapshot(m_lastTickAt);
+        } else if (inputChanged) {
+            // Between ticks: show the new input without moving the interpolation base
+            PublishSnapshot(m_lastTickAt);
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait_until(lock, nextTick, [this] {
+            return m_stopping.load() || m_inputPending.load(std::memory_order_relaxed);
+        });
+    }
+}
+
+bool Simulation::ApplyConfig() {
+    if (!m_configWatcher) {
+        return false;
+    }
+    const ConfigSnapshot& config = m_configWatcher->Acquire(m_configReader);
+    if (config.generation == m_configGeneration) {
+        return false;
+    }
+    m_configGeneration = config.generation;
+    double tickSeconds = 1.0 / std::max(1, config.settings.tickRate);
+    if (tickSeconds == m_tickSeconds) {
+        return false;
+    }
+    m_tickSeconds = tickSeconds;
+    return true;
+}
+
+void Simulation::Step(double dt) {
+    PROFILE_ZONE("Simulation::Step");
+    // This is where emulator state, APK execution etc. advance by one tick
+    m_state.tick++;
+    m_state.time += dt;
+}
+
+void Simulation::PublishSnapshot(std::chrono::steady_clock::time_point tickAt) {
+    SimulationSnapshot& snapshot = m_snapshots.GetWriteBuffer();
+    snapshot.previous = m_previousState;
+    snapshot.current = m_state;
+    snapshot.currentAt = tickAt;
+    snapshot.tickSeconds = m_tickSeconds;
+    snapshot.droppedTicks = m_droppedTicks;
+    snapshot.inputLatency = m_inputLatencyStats;
+    m_snapshots.Publish();
+}
@@ -0,0 +1,155 @@
+#include "StartupTrace.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct TraceEvent {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+    int thread;
+    bool mark;
+};
+
+// How long the process had already been running when this file's statics
+// were initialized (loading the executable and its DLLs); 0 if unknown.
+// Linux only knows the start to the clock tick (10 ms).
+uint64_t GetProcessAgeMicros() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user, now;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+        return 0;
+    }
+    GetSystemTimeAsFileTime(&now);
+    auto ticks = [](const FILETIME& time) {
+        return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    uint64_t createdTicks = ticks(created);
+    uint64_t nowTicks = ticks(now);
+    return nowTicks > createdTicks ? (nowTicks - createdTicks) / 10 : 0;
+#elif defined(__linux__)
+    // Field 22 of /proc/self/stat: start time in clock ticks since boot
+    std::ifstream stat("/proc/self/stat");
+    std::string line;
+    std::ifstream uptime("/proc/uptime");
+    double uptimeSeconds = 0.0;
+    if (!std::getline(stat, line) || !(uptime >> uptimeSeconds)) {
+        return 0;
+    }
+    size_t field = line.rfind(')');
+    unsigned long long startTicks = 0;
+    for (int i = 2; i < 22 && field != std::string::npos; ++i) {
+        field = line.find(' ', field + 1);
+    }
+    long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    if (field == std::string::npos || ticksPerSecond <= 0 ||
+        std::sscanf(line.c_str() + field + 1, "%llu", &startTicks) != 1) {
+        return 0;
+    }
+    double age = uptimeSeconds - static_cast<double>(startTicks) / ticksPerSecond;
+    return age > 0.0 ? static_cast<uint64_t>(age * 1e6) : 0;
+#else
+    return 0;
+#endif
+}
+
+// Process start on the steady clock
+const Clock::time_point g_processStart = Clock::now() - std::chrono::microseconds(GetProcessAgeMicros());
+
+std::mutex g_mutex;
+std::vector<TraceEvent> g_events;
+std::vector<std::string> g_threadNames;   // Indexed by trace thread id - 1
+int g_threadCount = 0;
+
+thread_local int t_thread = 0;
+
+// Call with g_mutex held
+int GetThreadId() {
+    if (t_thread == 0) {
+        t_thread = ++g_threadCount;
+        g_threadNames.resize(static_cast<size_t>(g_threadCount));
+    }
+    return t_thread;
+}
+
+} // namespace
+
+uint64_t StartupTrace::Now() {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - g_processStart).count();
+    return static_cast<uint64_t>(micros > 0 ? micros : 0);
+}
+
+void StartupTrace::AddPhase(const char* name, uint64_t beginMicros, uint64_t endMicros) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_events.push_back({name, beginMicros, endMicros, GetThreadId(), false});
+}
+
+void StartupTrace::AddMark(const char* name) {
+    uint64_t now = Now();
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_events.push_back({name, now, now, GetThreadId(), true});
+}
+
+void StartupTrace::SetThreadName(const char* name) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_threadNames[static_cast<size_t>(GetThreadId() - 1)] = name;
+}
+
+bool StartupTrace::Write(const std::string& filepath) {
+    json events = json::array();
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        for (size_t i = 0; i < g_threadNames.size(); ++i) {
+            if (!g_threadNames[i].empty()) {
+                events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", i + 1},
+                                  {"args", {{"name", g_threadNames[i]}}}});
+            }
+        }
+        for (const TraceEvent& event : g_events) {
+            json entry = {{"name", event.name}, {"cat", "startup"}, {"pid", 1}, {"tid", event.thread},
+                          {"ts", event.begin}};
+            if (event.mark) {
+                entry["ph"] = "i";
+                entry["s"] = "g";
+            } else {
+                entry["ph"] = "X";
+                entry["dur"] = event.end - event.begin;
+            }
+            events.push_back(std::move(entry));
+        }
+    }
+
+    json trace;
+    trace["traceEvents"] = std::move(events);
+    trace["displayTimeUnit"] = "ms";
+
+    std::ofstream file(filepath, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not write startup trace to " << filepath << std::endl;
+        return false;
+    }
+    file << trace.dump(1);
+    return static_cast<bool>(file);
+}
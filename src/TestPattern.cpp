@@ -0,0 +1,105 @@
+#include "TestPattern.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int kSquareSize = 64;
+constexpr int kCheckerSize = 8;
+
+// White, yellow, cyan, green, magenta, red, blue, black
+const uint8_t kBars[8][3] = {
+    {255, 255, 255}, {255, 255, 0}, {0, 255, 255}, {0, 255, 0},
+    {255, 0, 255}, {255, 0, 0}, {0, 0, 255}, {0, 0, 0}
+};
+
+// 0, 1, ..., period, period - 1, ..., 1, 0, ...
+int Bounce(uint64_t position, int period) {
+    if (period <= 0) {
+        return 0;
+    }
+    int phase = static_cast<int>(position % static_cast<uint64_t>(2 * period));
+    return phase <= period ? phase : 2 * period - phase;
+}
+
+} // namespace
+
+TestPattern::TestPattern(int width, int height, GuestPixelFormat format) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    int pitch = width * PixelConvert::GetBytesPerPixel(format);
+    m_pixels.assign(static_cast<size_t>(pitch) * height, 0);
+    m_frame = {m_pixels.data(), width, height, pitch, format};
+}
+
+void TestPattern::PutPixel(uint8_t* row, int x, uint8_t r, uint8_t g, uint8_t b) const {
+    switch (m_frame.format) {
+        case GuestPixelFormat::RGB565: {
+            uint16_t v = static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+            row[2 * x] = static_cast<uint8_t>(v);
+            row[2 * x + 1] = static_cast<uint8_t>(v >> 8);
+            break;
+        }
+        case GuestPixelFormat::BGRA8888:
+            row[4 * x + 0] = b;
+            row[4 * x + 1] = g;
+            row[4 * x + 2] = r;
+            row[4 * x + 3] = 255;
+            break;
+        case GuestPixelFormat::RGBA8888:
+            row[4 * x + 0] = r;
+            row[4 * x + 1] = g;
+            row[4 * x + 2] = b;
+            row[4 * x + 3] = 255;
+            break;
+    }
+}
+
+void TestPattern::FillSpan(uint8_t* row, int x0, int x1, uint8_t r, uint8_t g, uint8_t b) const {
+    for (int x = x0; x < x1; ++x) {
+        PutPixel(row, x, r, g, b);
+    }
+}
+
+const GuestFrame& TestPattern::Render(uint64_t tick) {
+    int width = m_frame.width;
+    int height = m_frame.height;
+    int barsHeight = height * 2 / 3;
+    int shift = static_cast<int>(tick * 4 % 256);
+
+    int squareSize = std::min({kSquareSize, width, barsHeight});
+    int squareX = Bounce(tick * 4, width - squareSize);
+    int squareY = (barsHeight - squareSize) / 2;
+
+    for (int y = 0; y < height; ++y) {
+        uint8_t* row = m_pixels.data() + static_cast<size_t>(y) * m_frame.pitch;
+
+        if (y < barsHeight) {
+            for (int bar = 0; bar < 8; ++bar) {
+                FillSpan(row, width * bar / 8, width * (bar + 1) / 8, kBars[bar][0], kBars[bar][1], kBars[bar][2]);
+            }
+        } else {
+            uint8_t green = static_cast<uint8_t>((y - barsHeight) * 255 / std::max(height - barsHeight - 1, 1));
+            for (int x = 0; x < width; ++x) {
+                uint8_t red = static_cast<uint8_t>(x * 256 / width + shift);
+                PutPixel(row, x, red, green, static_cast<uint8_t>(255 - red));
+            }
+        }
+
+        if (y >= squareY && y < squareY + squareSize) {
+            for (int x = 0; x < squareSize; ++x) {
+                bool light = ((x / kCheckerSize) + ((y - squareY) / kCheckerSize)) % 2 == 0;
+                uint8_t level = light ? 230 : 25;
+                PutPixel(row, squareX + x, level, level, level);
+            }
+        }
+
+        // Border: the outermost pixels must survive scaling
+        if (y == 0 || y == height - 1) {
+            FillSpan(row, 0, width, 255, 255, 255);
+        } else {
+            PutPixel(row, 0, 255, 255, 255);
+            PutPixel(row, width - 1, 255, 255, 255);
+        }
+    }
+    return m_frame;
+}
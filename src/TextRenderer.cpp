@@ -0,0 +1,206 @@
+#include "TextRenderer.h"
+#include "BitmapFont.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// FNV-1a over the string bytes
+uint64_t HashText(std::string_view s) {
+    uint64_t hash = 1469598103934665603ull;
+    for (char c : s) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+TextRenderer::TextRenderer(SDL_Renderer* renderer, int scale)
+    : m_renderer(renderer)
+    , m_atlas(nullptr)
+    , m_atlasWidth(0)
+    , m_atlasHeight(0)
+    , m_scale(std::max(scale, 1))
+    , m_cache(std::make_unique<Layout[]>(kCacheSlots))
+    , m_cacheHits(0)
+    , m_cacheMisses(0)
+{
+    for (size_t i = 0; i < kCacheSlots; ++i) {
+        m_cache[i].length = 0;
+    }
+
+    RecreateAtlas();
+}
+
+TextRenderer::~TextRenderer() {
+    if (m_atlas) {
+        SDL_DestroyTexture(m_atlas);
+    }
+}
+
+void TextRenderer::SetScale(int scale) {
+    scale = std::max(scale, 1);
+    if (scale == m_scale) {
+        return;
+    }
+    m_scale = scale;
+    for (size_t i = 0; i < kCacheSlots; ++i) {
+        m_cache[i].length = 0;
+    }
+}
+
+void TextRenderer::RecreateAtlas() {
+    if (m_atlas) {
+        SDL_DestroyTexture(m_atlas);
+        m_atlas = nullptr;
+    }
+    if (!CreateAtlas()) {
+        std::cerr << "Warning: Could not create the font atlas (" << SDL_GetError() << "), text is disabled" << std::endl;
+    }
+}
+
+bool TextRenderer::CreateAtlas() {
+    // One extra cell for the solid texels
+    int rows = (BitmapFont::kGlyphCount + 1 + kAtlasColumns - 1) / kAtlasColumns;
+    m_atlasWidth = kAtlasColumns * kCellWidth;
+    m_atlasHeight = rows * kCellHeight;
+
+    // White glyphs on transparent texels; the vertex colour tints them
+    std::vector<uint32_t> pixels(static_cast<size_t>(m_atlasWidth) * m_atlasHeight, 0);
+    for (int glyph = 0; glyph < BitmapFont::kGlyphCount; ++glyph) {
+        const uint8_t* columns = BitmapFont::GetGlyphColumns(glyph);
+        int cellX = (glyph % kAtlasColumns) * kCellWidth;
+        int cellY = (glyph / kAtlasColumns) * kCellHeight;
+        for (int x = 0; x < BitmapFont::kGlyphWidth; ++x) {
+            for (int y = 0; y < BitmapFont::kGlyphHeight; ++y) {
+                if (columns[x] & (1u << y)) {
+                    pixels[static_cast<size_t>(cellY + y) * m_atlasWidth + cellX + x] = 0xFFFFFFFFu;
+                }
+            }
+        }
+    }
+    int solidX = (BitmapFont::kGlyphCount % kAtlasColumns) * kCellWidth;
+    int solidY = (BitmapFont::kGlyphCount / kAtlasColumns) * kCellHeight;
+    for (int y = 0; y < kCellHeight; ++y) {
+        std::fill_n(&pixels[static_cast<size_t>(solidY + y) * m_atlasWidth + solidX], kCellWidth, 0xFFFFFFFFu);
+    }
+
+    m_atlas = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+                                m_atlasWidth, m_atlasHeight);
+    if (!m_atlas) {
+        return false;
+    }
+    if (SDL_UpdateTexture(m_atlas, nullptr, pixels.data(), m_atlasWidth * static_cast<int>(sizeof(uint32_t))) != 0) {
+        SDL_DestroyTexture(m_atlas);
+        m_atlas = nullptr;
+        return false;
+    }
+    SDL_SetTextureBlendMode(m_atlas, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(m_atlas, SDL_ScaleModeNearest);
+    return true;
+}
+
+void TextRenderer::AppendText(std::string_view text, int x, int y, SDL_Color color, std::vector<SDL_Vertex>& out) {
+    if (!m_atlas || text.empty()) {
+        return;
+    }
+
+    // Too long for a layout: placed glyph by glyph
+    if (text.size() > kMaxCachedLength) {
+        LayOut(text, [&](int glyphX, int glyphY, int glyph) {
+            AppendGlyph(static_cast<float>(x + glyphX), static_cast<float>(y + glyphY), glyph, color, out);
+        });
+        return;
+    }
+
+    const Layout& layout = GetLayout(text);
+    for (size_t i = 0; i < layout.quadCount; ++i) {
+        const GlyphQuad& quad = layout.quads[i];
+        AppendGlyph(static_cast<float>(x + quad.x), static_cast<float>(y + quad.y), quad.glyph, color, out);
+    }
+}
+
+void TextRenderer::AppendSolid(const SDL_FRect& rect, SDL_Color color, std::vector<SDL_Vertex>& out) const {
+    // Every corner samples the middle of the solid cell
+    float u = ((BitmapFont::kGlyphCount % kAtlasColumns) * kCellWidth + kCellWidth * 0.5f) / m_atlasWidth;
+    float v = ((BitmapFont::kGlyphCount / kAtlasColumns) * kCellHeight + kCellHeight * 0.5f) / m_atlasHeight;
+
+    out.push_back({{rect.x, rect.y}, color, {u, v}});
+    out.push_back({{rect.x + rect.w, rect.y}, color, {u, v}});
+    out.push_back({{rect.x, rect.y + rect.h}, color, {u, v}});
+    out.push_back({{rect.x + rect.w, rect.y + rect.h}, color, {u, v}});
+}
+
+SDL_Point TextRenderer::MeasureText(std::string_view text) {
+    if (text.size() > kMaxCachedLength) {
+        return LayOut(text, [](int, int, int) {});
+    }
+    return GetLayout(text).size;
+}
+
+const TextRenderer::Layout& TextRenderer::GetLayout(std::string_view text) {
+    uint64_t hash = HashText(text);
+    Layout& slot = m_cache[hash % kCacheSlots];
+    if (slot.length == text.size() && slot.hash == hash &&
+        std::memcmp(slot.text, text.data(), text.size()) == 0) {
+        ++m_cacheHits;
+        return slot;
+    }
+
+    ++m_cacheMisses;
+    BuildLayout(text, slot);
+    slot.hash = hash;
+    return slot;
+}
+
+void TextRenderer::BuildLayout(std::string_view text, Layout& layout) const {
+    layout.length = static_cast<uint16_t>(text.size());
+    layout.quadCount = 0;
+    std::memcpy(layout.text, text.data(), text.size());
+
+    layout.size = LayOut(text, [&layout](int x, int y, int glyph) {
+        layout.quads[layout.quadCount++] = {static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<uint8_t>(glyph)};
+    });
+}
+
+template <typename Visit>
+SDL_Point TextRenderer::LayOut(std::string_view text, Visit&& visit) const {
+    // Fixed-pitch font: one cell per character, blank glyphs take no quad
+    int advance = kCellWidth * m_scale;
+    int lineHeight = GetLineHeight();
+    int penX = 0;
+    int penY = 0;
+    int width = 0;
+
+    for (char c : text) {
+        if (c == '\n') {
+            penX = 0;
+            penY += lineHeight;
+            continue;
+        }
+        if (c != ' ') {
+            visit(penX, penY, BitmapFont::GetGlyphIndex(c));
+        }
+        penX += advance;
+        width = std::max(width, penX);
+    }
+
+    return {width, text.empty() ? 0 : penY + lineHeight};
+}
+
+void TextRenderer::AppendGlyph(float x, float y, int glyph, SDL_Color color, std::vector<SDL_Vertex>& out) const {
+    float w = static_cast<float>(BitmapFont::kGlyphWidth * m_scale);
+    float h = static_cast<float>(BitmapFont::kGlyphHeight * m_scale);
+    float u0 = static_cast<float>((glyph % kAtlasColumns) * kCellWidth) / m_atlasWidth;
+    float v0 = static_cast<float>((glyph / kAtlasColumns) * kCellHeight) / m_atlasHeight;
+    float u1 = u0 + static_cast<float>(BitmapFont::kGlyphWidth) / m_atlasWidth;
+    float v1 = v0 + static_cast<float>(BitmapFont::kGlyphHeight) / m_atlasHeight;
+
+    out.push_back({{x, y}, color, {u0, v0}});
+    out.push_back({{x + w, y}, color, {u1, v0}});
+    out.push_back({{x, y + h}, color, {u0, v1}});
+    out.push_back({{x + w, y + h}, color, {u1, v1}});
+}
@@ -0,0 +1,125 @@
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+namespace {
+
+// Lets a task submitted from inside a worker go to that worker's own queue
+thread_local const ThreadPool* t_currentPool = nullptr;
+thread_local size_t t_currentIndex = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : m_queued(0)
+    , m_nextQueue(0)
+    , m_stopping(false)
+{
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) {
+            threadCount = 4;
+        }
+    }
+
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    size_t index = (t_currentPool == this)
+        ? t_currentIndex
+        : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+    // Counted before it is published, so a worker's decrement after popping
+    // it can never take the count below zero
+    m_queued.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // A worker checks the count under the wake mutex before sleeping;
+        // passing through it orders this notify after any such check
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+    }
+    m_wakeCondition.notify_one();
+}
+
+bool ThreadPool::PopTask(size_t index, std::function<void()>& task, bool waitForSteal) {
+    // Own queue first, newest task
+    {
+        WorkQueue& own = *m_queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Then steal the oldest task from a sibling
+    for (size_t offset = 1; offset < m_queues.size(); ++offset) {
+        WorkQueue& victim = *m_queues[(index + offset) % m_queues.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::defer_lock);
+        if (waitForSteal) {
+            lock.lock();
+        } else if (!lock.try_lock()) {
+            continue;
+        }
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+    t_currentPool = this;
+    t_currentIndex = index;
+    Profiler::SetThreadName("pool worker");
+
+    for (;;) {
+        std::function<void()> task;
+        // A try_lock steal can skip the only queue with work in it; if work
+        // is known to exist, look again waiting for each queue's lock
+        if (PopTask(index, task, false) ||
+            (m_queued.load(std::memory_order_relaxed) > 0 && PopTask(index, task, true))) {
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        if (m_queued.load(std::memory_order_relaxed) > 0) {
+            // Counted but not pushed yet, or popped but not yet uncounted:
+            // either resolves within a few instructions
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        if (m_stopping) {
+            return;
+        }
+        m_wakeCondition.wait(lock, [this] {
+            return m_stopping || m_queued.load(std::memory_order_relaxed) > 0;
+        });
+    }
+}
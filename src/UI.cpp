@@ -1,96 +1,177 @@
 #include "UI.h"
-#include <sstream>
-#include <iomanip>
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// FNV-1a; widget keys only need to change when the displayed text does
+uint64_t HashText(uint64_t hash, std::string_view text) {
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+constexpr uint64_t kHashSeed = 1469598103934665603ull;
+
+} // namespace
 
 UI::UI(SDL_Renderer* renderer)
     : m_renderer(renderer)
     , m_showDebug(false)
     , m_showAbout(false)
     , m_showMenu(false)
+    , m_text(std::make_unique<TextRenderer>(renderer))
+    , m_menuKey(kNotBuilt)
+    , m_aboutKey(kNotBuilt)
+    , m_debugKey(kNotBuilt)
+    , m_fpsKey(kNotBuilt)
+    , m_layer(nullptr)
+    , m_layerWidth(0)
+    , m_layerHeight(0)
+    , m_frameLayers(0)
+    , m_cachedLayers(0)
+    , m_layerDirty(true)
+    , m_frameDebug(false)
+    , m_frameFPS(false)
+    , m_lastDrawCalls(0)
+    , m_rebuilds(0)
+    , m_layerRedraws(0)
 {
     m_textColor = {255, 255, 255, 255};
     m_bgColor = {30, 30, 40, 200};
     m_accentColor = {100, 150, 255, 255};
+    
+    m_menuList = std::make_unique<DrawList>(*m_text);
+    m_apkList = std::make_unique<DrawList>(*m_text);
+    m_aboutList = std::make_unique<DrawList>(*m_text);
+    m_debugList = std::make_unique<DrawList>(*m_text);
+    m_fpsList = std::make_unique<DrawList>(*m_text);
+    
+    m_apkView = std::make_unique<VirtualList>(*m_text);
+    SetOutputSize(UILayout::kDesignWidth, UILayout::kDesignHeight);
 }
 
 UI::~UI() {
+    if (m_layer) {
+        SDL_DestroyTexture(m_layer);
+    }
 }
 
 void UI::RenderFPS(float fps, float frameTime) {
+    PROFILE_ZONE("UI::RenderFPS");
     // Render FPS in top-right corner
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(1) << fps << " FPS";
-    std::string fpsText = oss.str();
-    
-    // Simple text rendering using rectangles (SDL2 doesn't have built-in text rendering)
-    // In a production app, you'd use SDL_ttf
-    int x = 10;
-    int y = 10;
-    
-    // Background for FPS counter
-    DrawRect(x - 5, y - 5, 120, 25, {0, 0, 0, 180}, true);
-    
-    // Draw FPS text (simplified - using colored rectangles as placeholder)
-    // For real text, you'd need SDL_ttf or similar
-    SDL_Color color = (fps >= 55.0f) ? SDL_Color{0, 255, 0, 255} : 
-                      (fps >= 30.0f) ? SDL_Color{255, 255, 0, 255} : 
+    char fpsText[32];
+    int length = std::snprintf(fpsText, sizeof(fpsText), "%.1f FPS", fps);
+    std::string_view text(fpsText, length > 0 ? static_cast<size_t>(length) : 0);
+    (void)frameTime;
+    m_frameFPS = true;
+    
+    // The colour follows from the text, so the text alone keys the rebuild
+    uint64_t key = HashText(kHashSeed, text);
+    if (key == m_fpsKey) {
+        return;
+    }
+    m_fpsKey = key;
+    ++m_rebuilds;
+    
+    const SDL_Rect& origin = m_layout.GetRect(LayoutRegion::FPSCounter);
+    int x = origin.x;
+    int y = origin.y;
+    int padding = m_layout.Scale(5);
+    
+    // Background for FPS counter, sized to the text
+    SDL_Point size = m_text->MeasureText(text);
+    m_fpsList->Clear();
+    m_fpsList->AddRect(x - padding, y - padding, size.x + 2 * padding, size.y + padding + m_layout.Scale(3), {0, 0, 0, 180});
+    
+    SDL_Color color = (fps >= 55.0f) ? SDL_Color{0, 255, 0, 255} :
+                      (fps >= 30.0f) ? SDL_Color{255, 255, 0, 255} :
                       SDL_Color{255, 0, 0, 255};
     
-    // Placeholder: draw a small indicator
-    DrawRect(x, y, 100, 15, color, true);
+    m_fpsList->AddText(text, x, y, color);
 }
 
-void UI::RenderDebugOverlay(const std::vector<std::string>& debugInfo) {
-    int x = 10;
-    int y = 50;
-    int lineHeight = 20;
-    int padding = 10;
+void UI::RenderDebugOverlay(const std::string_view* lines, size_t lineCount) {
+    PROFILE_ZONE("UI::RenderDebugOverlay");
+    m_frameDebug = true;
     
-    // Calculate overlay size
-    int maxWidth = 300;
-    int height = static_cast<int>(debugInfo.size()) * lineHeight + padding * 2;
+    uint64_t key = kHashSeed;
+    for (size_t i = 0; i < lineCount; ++i) {
+        key = HashText(key, lines[i]);
+        key = HashText(key, "\n");
+    }
+    if (key == m_debugKey) {
+        return;
+    }
+    m_debugKey = key;
+    ++m_rebuilds;
     
-    // Background
-    DrawRect(x, y, maxWidth, height, m_bgColor, true);
+    const SDL_Rect& origin = m_layout.GetRect(LayoutRegion::DebugOverlay);
+    int x = origin.x;
+    int y = origin.y;
+    int lineHeight = std::max(m_layout.Scale(20), m_text->GetLineHeight() + m_layout.Scale(4));
+    int padding = m_layout.Scale(10);
+    int indicator = m_layout.Scale(5);
     
-    // Border
-    SDL_Rect border = {x, y, maxWidth, height};
-    SDL_SetRenderDrawColor(m_renderer, m_accentColor.r, m_accentColor.g, m_accentColor.b, 255);
-    SDL_RenderDrawRect(m_renderer, &border);
+    // Calculate overlay size from the widest line
+    int maxWidth = m_layout.Scale(300);
+    for (size_t i = 0; i < lineCount; ++i) {
+        maxWidth = std::max(maxWidth, m_text->MeasureText(lines[i]).x + padding * 3);
+    }
+    int height = static_cast<int>(lineCount) * lineHeight + padding * 2;
+    
+    // Background and border
+    m_debugList->Clear();
+    m_debugList->AddRect(x, y, maxWidth, height, m_bgColor);
+    m_debugList->AddRectOutline(x, y, maxWidth, height, m_accentColor);
     
-    // Draw debug info (simplified - would need text rendering in production)
     int currentY = y + padding;
-    for (size_t i = 0; i < debugInfo.size(); ++i) {
-        // Placeholder: draw indicator for each line
-        DrawRect(x + padding, currentY, 5, lineHeight - 5, m_accentColor, true);
+    for (size_t i = 0; i < lineCount; ++i) {
+        m_debugList->AddRect(x + padding, currentY, indicator, lineHeight - indicator, m_accentColor);
+        m_debugList->AddText(lines[i], x + padding * 2, currentY, m_textColor);
         currentY += lineHeight;
     }
 }
 
 void UI::RenderAboutScreen() {
-    int width = 600;
-    int height = 400;
-    int x = (1280 - width) / 2; // Center horizontally (assuming 1280 width)
-    int y = (720 - height) / 2;  // Center vertically (assuming 720 height)
-    
-    // Background
-    DrawRect(x, y, width, height, m_bgColor, true);
+    PROFILE_ZONE("UI::RenderAboutScreen");
+    m_frameLayers |= kLayerAbout;
+    if (m_aboutKey != m_layout.GetGeneration()) {
+        BuildAboutScreen(*m_aboutList);
+        m_aboutKey = m_layout.GetGeneration();
+        m_layerDirty = true;
+        ++m_rebuilds;
+    }
+}
+
+void UI::BuildAboutScreen(DrawList& list) {
+    const SDL_Rect& bounds = m_layout.GetRect(LayoutRegion::About);
+    int x = bounds.x;
+    int y = bounds.y;
+    int width = bounds.w;
+    int height = bounds.h;
     
-    // Border
-    SDL_Rect border = {x, y, width, height};
-    SDL_SetRenderDrawColor(m_renderer, m_accentColor.r, m_accentColor.g, m_accentColor.b, 255);
-    SDL_RenderDrawRect(m_renderer, &border);
+    // Background and border
+    list.Clear();
+    list.AddRect(x, y, width, height, m_bgColor);
+    list.AddRectOutline(x, y, width, height, m_accentColor);
+    list.SetClipRect(&bounds);
     
     // Title
-    int titleY = y + 40;
-    DrawRect(x + 20, titleY, width - 40, 3, m_accentColor, true);
+    int titleY = y + m_layout.Scale(40);
+    int inset = m_layout.Scale(20);
+    list.AddText("About", x + inset, titleY - m_text->GetLineHeight() - m_layout.Scale(6), m_accentColor);
+    list.AddRect(x + inset, titleY, width - 2 * inset, m_layout.Scale(3), m_accentColor);
     
-    // About text (simplified - would need text rendering)
-    int textY = titleY + 60;
-    int lineHeight = 30;
+    // About text
+    int textY = titleY + m_layout.Scale(60);
+    int lineHeight = m_layout.Scale(30);
     
     // Developer info
-    std::vector<std::string> aboutLines = {
+    static const char* const aboutLines[] = {
         "Built by Adarsh Jaiswal",
         "Web Developer",
         "Instagram: @adar.xhevil",
@@ -100,34 +181,44 @@ void UI::RenderAboutScreen() {
         "Press ESC to close"
     };
     
-    for (size_t i = 0; i < aboutLines.size(); ++i) {
-        // Placeholder: draw indicator for each line
-        int lineX = x + 50;
-        int lineWidth = (i == 0) ? 200 : 150; // First line (name) is wider
-        DrawRect(lineX, textY + i * lineHeight, lineWidth, 20, m_textColor, true);
+    for (size_t i = 0; i < sizeof(aboutLines) / sizeof(aboutLines[0]); ++i) {
+        list.AddText(aboutLines[i], x + m_layout.Scale(50), textY + static_cast<int>(i) * lineHeight, m_textColor);
     }
+    list.SetClipRect(nullptr);
 }
 
 void UI::RenderMainMenu() {
-    int menuWidth = 300;
-    int menuHeight = 400;
-    int x = 50;
-    int y = 100;
-    
-    // Background
-    DrawRect(x, y, menuWidth, menuHeight, m_bgColor, true);
+    PROFILE_ZONE("UI::RenderMainMenu");
+    m_frameLayers |= kLayerMenu;
+    if (m_menuKey != m_layout.GetGeneration()) {
+        BuildMainMenu(*m_menuList);
+        m_menuKey = m_layout.GetGeneration();
+        m_layerDirty = true;
+        ++m_rebuilds;
+    }
+}
+
+void UI::BuildMainMenu(DrawList& list) {
+    const SDL_Rect& bounds = m_layout.GetRect(LayoutRegion::Menu);
+    int menuWidth = bounds.w;
+    int menuHeight = bounds.h;
+    int x = bounds.x;
+    int y = bounds.y;
     
-    // Border
-    SDL_Rect border = {x, y, menuWidth, menuHeight};
-    SDL_SetRenderDrawColor(m_renderer, m_accentColor.r, m_accentColor.g, m_accentColor.b, 255);
-    SDL_RenderDrawRect(m_renderer, &border);
+    // Background and border; items past a shortened menu are cut off
+    list.Clear();
+    list.AddRect(x, y, menuWidth, menuHeight, m_bgColor);
+    list.AddRectOutline(x, y, menuWidth, menuHeight, m_accentColor);
+    list.SetClipRect(&bounds);
     
-    // Menu items (simplified)
-    int itemY = y + 40;
-    int itemHeight = 40;
-    int itemSpacing = 10;
+    // Menu items
+    int itemY = y + m_layout.Scale(40);
+    int itemHeight = m_layout.Scale(40);
+    int itemSpacing = m_layout.Scale(10);
+    int inset = m_layout.Scale(20);
+    int indicator = m_layout.Scale(5);
     
-    std::vector<std::string> menuItems = {
+    static const char* const menuItems[] = {
         "Load APK",
         "Installed APKs",
         "Settings",
@@ -135,29 +226,145 @@ void UI::RenderMainMenu() {
         "Exit"
     };
     
-    for (size_t i = 0; i < menuItems.size(); ++i) {
-        int itemX = x + 20;
-        int itemWidth = menuWidth - 40;
-        int currentY = itemY + i * (itemHeight + itemSpacing);
+    for (size_t i = 0; i < sizeof(menuItems) / sizeof(menuItems[0]); ++i) {
+        int itemX = x + inset;
+        int itemWidth = menuWidth - 2 * inset;
+        int currentY = itemY + static_cast<int>(i) * (itemHeight + itemSpacing);
         
         // Menu item background
-        DrawRect(itemX, currentY, itemWidth, itemHeight, {50, 50, 60, 255}, true);
+        list.AddRect(itemX, currentY, itemWidth, itemHeight, {50, 50, 60, 255});
         
-        // Menu item indicator
-        DrawRect(itemX + 5, currentY + 5, 5, itemHeight - 10, m_accentColor, true);
+        // Menu item indicator and label
+        list.AddRect(itemX + indicator, currentY + indicator, indicator, itemHeight - 2 * indicator, m_accentColor);
+        list.AddText(menuItems[i], itemX + inset, currentY + (itemHeight - m_text->GetLineHeight()) / 2, m_textColor);
     }
+    list.SetClipRect(nullptr);
 }
 
-void UI::RenderAPKList(const std::vector<std::string>& apkList) {
-    // Render list of APKs
-    int x = 400;
-    int y = 100;
-    int itemHeight = 30;
+void UI::RenderAPKList(const std::vector<std::string_view>& apkList, uint64_t generation) {
+    PROFILE_ZONE("UI::RenderAPKList");
+    m_frameLayers |= kLayerAPKList;
     
-    for (size_t i = 0; i < apkList.size(); ++i) {
-        int currentY = y + i * itemHeight;
-        DrawRect(x, currentY, 400, itemHeight - 5, {40, 40, 50, 255}, true);
+    // Also advances an unfinished filter pass by one budgeted step
+    m_apkView->SetItems(&apkList, generation);
+    if (!m_apkView->IsDirty()) {
+        return;
     }
+    m_apkView->Build(*m_apkList);
+    m_layerDirty = true;
+    ++m_rebuilds;
+}
+
+bool UI::SetOutputSize(int width, int height) {
+    if (!m_layout.Update(width, height)) {
+        return false;
+    }
+    
+    // Everything placed in design units is rebuilt at the new scale
+    m_text->SetScale(m_layout.GetTextScale());
+    m_apkView->SetMetrics(m_layout.Scale(30), m_layout.Scale(34));
+    m_apkView->SetBounds(m_layout.GetRect(LayoutRegion::APKList));
+    m_debugKey = kNotBuilt;
+    m_fpsKey = kNotBuilt;
+    m_layerDirty = true;
+    return true;
+}
+
+void UI::Update(float deltaTime) {
+    m_apkView->Update(deltaTime);
+}
+
+void UI::EndFrame() {
+    PROFILE_ZONE("UI::EndFrame");
+    int drawCalls = 0;
+    
+    // Static widgets: replay the cached layer, redrawing it only if its contents changed
+    if (m_frameLayers != 0) {
+        if (EnsureLayer()) {
+            if (m_layerDirty || m_frameLayers != m_cachedLayers) {
+                SDL_SetRenderTarget(m_renderer, m_layer);
+                SDL_SetRenderDrawColor(m_renderer, 0, 0, 0, 0);
+                SDL_RenderClear(m_renderer);
+                drawCalls += DrawLayerWidgets();
+                SDL_SetRenderTarget(m_renderer, nullptr);
+                
+                m_cachedLayers = m_frameLayers;
+                m_layerDirty = false;
+                ++m_layerRedraws;
+            }
+            SDL_RenderCopy(m_renderer, m_layer, nullptr, nullptr);
+            ++drawCalls;
+        } else {
+            // No render targets: replay the draw lists directly
+            drawCalls += DrawLayerWidgets();
+        }
+    }
+    
+    // Per-frame overlays on top
+    if (m_frameDebug) {
+        drawCalls += m_debugList->Submit(m_renderer);
+    }
+    if (m_frameFPS) {
+        drawCalls += m_fpsList->Submit(m_renderer);
+    }
+    
+    m_lastDrawCalls = drawCalls;
+    m_frameLayers = 0;
+    m_frameDebug = false;
+    m_frameFPS = false;
+}
+
+void UI::InvalidateCache() {
+    m_text->RecreateAtlas();
+    m_layerDirty = true;
+}
+
+bool UI::EnsureLayer() {
+    if (!SDL_RenderTargetSupported(m_renderer)) {
+        return false;
+    }
+    
+    int width = m_layout.GetOutputWidth();
+    int height = m_layout.GetOutputHeight();
+    if (m_layer && width == m_layerWidth && height == m_layerHeight) {
+        return true;
+    }
+    
+    if (m_layer) {
+        SDL_DestroyTexture(m_layer);
+    }
+    m_layer = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!m_layer) {
+        return false;
+    }
+    
+    // Widgets blended onto a transparent target leave premultiplied colour, so
+    // the layer is composited with premultiplied alpha where the renderer allows it
+    SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+    if (SDL_SetTextureBlendMode(m_layer, premultiplied) != 0) {
+        SDL_SetTextureBlendMode(m_layer, SDL_BLENDMODE_BLEND);
+    }
+    
+    m_layerWidth = width;
+    m_layerHeight = height;
+    m_layerDirty = true;
+    return true;
+}
+
+int UI::DrawLayerWidgets() {
+    int drawCalls = 0;
+    if (m_frameLayers & kLayerMenu) {
+        drawCalls += m_menuList->Submit(m_renderer);
+    }
+    if (m_frameLayers & kLayerAPKList) {
+        drawCalls += m_apkList->Submit(m_renderer);
+    }
+    if (m_frameLayers & kLayerAbout) {
+        drawCalls += m_aboutList->Submit(m_renderer);
+    }
+    return drawCalls;
 }
 
 bool UI::HandleClick(int x, int y) {
@@ -166,27 +373,33 @@ bool UI::HandleClick(int x, int y) {
     return false;
 }
 
-void UI::DrawText(const std::string& text, int x, int y, SDL_Color color) {
-    // Placeholder for text rendering
-    // In production, use SDL_ttf or similar
-    (void)text;
-    (void)x;
-    (void)y;
-    (void)color;
+bool UI::HandleKey(SDL_Scancode scancode) {
+    switch (scancode) {
+        case SDL_SCANCODE_BACKSPACE:
+            m_apkView->EraseFilterChar();
+            return true;
+        case SDL_SCANCODE_UP:
+            m_apkView->ScrollRows(-1.0f);
+            return true;
+        case SDL_SCANCODE_DOWN:
+            m_apkView->ScrollRows(1.0f);
+            return true;
+        case SDL_SCANCODE_PAGEUP:
+            m_apkView->ScrollPages(-1.0f);
+            return true;
+        case SDL_SCANCODE_PAGEDOWN:
+            m_apkView->ScrollPages(1.0f);
+            return true;
+        default:
+            return false;
+    }
 }
 
-void UI::DrawRect(int x, int y, int w, int h, SDL_Color color, bool filled) {
-    SDL_Rect rect = {x, y, w, h};
-    SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
-    
-    if (filled) {
-        SDL_RenderFillRect(m_renderer, &rect);
-    } else {
-        SDL_RenderDrawRect(m_renderer, &rect);
-    }
+void UI::HandleTextInput(const char* text) {
+    m_apkView->AppendFilter(text);
 }
 
-void UI::DrawLine(int x1, int y1, int x2, int y2, SDL_Color color) {
-    SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
-    SDL_RenderDrawLine(m_renderer, x1, y1, x2, y2);
+void UI::HandleScroll(float wheelY) {
+    // Wheel up (positive) moves towards the top of the list; three rows per notch
+    m_apkView->ScrollRows(-3.0f * wheelY);
 }
@@ -0,0 +1,89 @@
+#include "UILayout.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Design-unit constants (at 1280x720)
+constexpr int kContentMargin = 100;
+constexpr int kMenuX = 50;
+constexpr int kMenuY = 100;
+constexpr int kMenuWidth = 300;
+constexpr int kMenuHeight = 400;
+constexpr int kListGap = 50;
+constexpr int kListMaxWidth = 600;
+constexpr int kAboutWidth = 600;
+constexpr int kAboutHeight = 400;
+constexpr int kScreenMargin = 10;
+constexpr int kBaseTextScale = 2;
+
+SDL_Rect FromEdges(int left, int top, int right, int bottom) {
+    return {left, top, std::max(right - left, 0), std::max(bottom - top, 0)};
+}
+
+} // namespace
+
+UILayout::UILayout()
+    : m_outputWidth(0)
+    , m_outputHeight(0)
+    , m_scale(1.0f)
+    , m_textScale(kBaseTextScale)
+    , m_generation(0)
+{
+    m_rects.fill({0, 0, 0, 0});
+}
+
+bool UILayout::Update(int outputWidth, int outputHeight) {
+    if (outputWidth == m_outputWidth && outputHeight == m_outputHeight) {
+        return false;
+    }
+    m_outputWidth = outputWidth;
+    m_outputHeight = outputHeight;
+    Solve();
+    ++m_generation;
+    return true;
+}
+
+int UILayout::Scale(int dp) const {
+    return static_cast<int>(std::lround(dp * m_scale));
+}
+
+void UILayout::Solve() {
+    int width = std::max(m_outputWidth, 1);
+    int height = std::max(m_outputHeight, 1);
+
+    // The largest scale at which the design resolution still fits
+    m_scale = std::min(static_cast<float>(width) / kDesignWidth, static_cast<float>(height) / kDesignHeight);
+    m_textScale = std::max(1, static_cast<int>(std::lround(kBaseTextScale * m_scale)));
+
+    // Content: the output minus a margin on every side, never thinner than half of it
+    int marginX = std::min(Scale(kContentMargin), width / 4);
+    int marginY = std::min(Scale(kContentMargin), height / 4);
+    SDL_Rect content = FromEdges(marginX, marginY, width - marginX, height - marginY);
+
+    // Menu: pinned to the top-left, shrunk if the output is too short
+    int menuTop = Scale(kMenuY);
+    SDL_Rect menu = {Scale(kMenuX), menuTop, Scale(kMenuWidth),
+                     std::max(std::min(Scale(kMenuHeight), height - menuTop - Scale(kScreenMargin)), 0)};
+
+    // APK list: right of the menu, down to the content's bottom edge, capped in width
+    int listLeft = menu.x + menu.w + Scale(kListGap);
+    int listRight = std::min(listLeft + Scale(kListMaxWidth), content.x + content.w);
+    SDL_Rect list = FromEdges(listLeft, content.y, listRight, content.y + content.h);
+
+    // About: centred, clamped to the output
+    int aboutWidth = std::min(Scale(kAboutWidth), width - 2 * Scale(kScreenMargin));
+    int aboutHeight = std::min(Scale(kAboutHeight), height - 2 * Scale(kScreenMargin));
+    SDL_Rect about = {(width - aboutWidth) / 2, (height - aboutHeight) / 2, aboutWidth, aboutHeight};
+
+    // Overlays only use their origin
+    SDL_Rect fps = {Scale(kScreenMargin), Scale(kScreenMargin), 0, 0};
+    SDL_Rect debug = {Scale(kScreenMargin), Scale(50), 0, 0};
+
+    m_rects[static_cast<size_t>(LayoutRegion::Content)] = content;
+    m_rects[static_cast<size_t>(LayoutRegion::Menu)] = menu;
+    m_rects[static_cast<size_t>(LayoutRegion::APKList)] = list;
+    m_rects[static_cast<size_t>(LayoutRegion::About)] = about;
+    m_rects[static_cast<size_t>(LayoutRegion::DebugOverlay)] = debug;
+    m_rects[static_cast<size_t>(LayoutRegion::FPSCounter)] = fps;
+}
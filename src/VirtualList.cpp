@@ -0,0 +1,315 @@
+#include "VirtualList.h"
+#include "DrawList.h"
+#include "TextRenderer.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+// Velocity decays by e^-kFriction per second; a scroll of N rows starts at
+// N * rowHeight * kFriction px/s and so glides exactly N rows
+constexpr float kFriction = 8.0f;
+constexpr float kStopVelocity = 2.0f;
+
+const SDL_Color kTextColor = {255, 255, 255, 255};
+const SDL_Color kDimTextColor = {150, 150, 170, 255};
+const SDL_Color kRowColor = {40, 40, 50, 255};
+const SDL_Color kHeaderColor = {50, 50, 60, 255};
+const SDL_Color kAccentColor = {100, 150, 255, 255};
+
+inline char ToLower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+} // namespace
+
+VirtualList::VirtualList(TextRenderer& text)
+    : m_text(text)
+    , m_bounds{0, 0, 0, 0}
+    , m_rowHeight(30)
+    , m_headerHeight(34)
+    , m_padding(8)
+    , m_scrollbarWidth(6)
+    , m_items(nullptr)
+    , m_generation(0)
+    , m_narrowing(false)
+    , m_scanPosition(0)
+    , m_filterPending(false)
+    , m_scroll(0.0f)
+    , m_velocity(0.0f)
+    , m_dirty(true)
+    , m_builtScroll(0)
+    , m_builtMatches(0)
+{
+    m_filter.reserve(64);
+    m_lowerFilter.reserve(64);
+}
+
+VirtualList::~VirtualList() {
+}
+
+void VirtualList::SetBounds(const SDL_Rect& bounds) {
+    if (bounds.x == m_bounds.x && bounds.y == m_bounds.y && bounds.w == m_bounds.w && bounds.h == m_bounds.h) {
+        return;
+    }
+    m_bounds = bounds;
+    ResetRows();
+}
+
+void VirtualList::SetMetrics(int rowHeight, int headerHeight) {
+    rowHeight = std::max(rowHeight, 1);
+    if (rowHeight == m_rowHeight && headerHeight == m_headerHeight) {
+        return;
+    }
+
+    // Keep the same row at the top
+    m_scroll = m_scroll / m_rowHeight * rowHeight;
+    m_velocity = m_velocity / m_rowHeight * rowHeight;
+    m_rowHeight = rowHeight;
+    m_headerHeight = headerHeight;
+    m_padding = std::max(rowHeight / 4, 2);
+    m_scrollbarWidth = std::max(rowHeight / 5, 3);
+    ResetRows();
+}
+
+void VirtualList::ResetRows() {
+    // Enough slots for a partial row at the top and at the bottom; labels are
+    // fitted to the width, so every slot is rebound
+    size_t slots = static_cast<size_t>(std::max(GetListHeight(), 0) / m_rowHeight + 2);
+    m_rows.assign(slots, Row{kNoItem, std::string_view()});
+    m_dirty = true;
+}
+
+void VirtualList::SetItems(const std::vector<std::string_view>* items, uint64_t generation) {
+    if (items != m_items || generation != m_generation) {
+        m_items = items;
+        m_generation = generation;
+
+        // Labels may point into storage that changed
+        for (Row& row : m_rows) {
+            row.item = kNoItem;
+        }
+        RestartFilter(false);
+    }
+
+    if (m_filterPending) {
+        StepFilter();
+    }
+}
+
+void VirtualList::AppendFilter(std::string_view text) {
+    // A longer filter can only match a subset of the current matches
+    bool narrow = !m_filter.empty();
+    m_filter.append(text.data(), text.size());
+    RestartFilter(narrow);
+    ResetScroll();
+}
+
+void VirtualList::EraseFilterChar() {
+    if (m_filter.empty()) {
+        return;
+    }
+    // Drop a whole UTF-8 sequence, not just its last byte
+    size_t length = m_filter.size() - 1;
+    while (length > 0 && (static_cast<unsigned char>(m_filter[length]) & 0xC0) == 0x80) {
+        --length;
+    }
+    m_filter.resize(length);
+    RestartFilter(false);
+    ResetScroll();
+}
+
+void VirtualList::SetFilter(std::string_view filter) {
+    bool narrow = !m_filter.empty() && filter.size() > m_filter.size() &&
+                  filter.substr(0, m_filter.size()) == m_filter;
+    m_filter.assign(filter.data(), filter.size());
+    RestartFilter(narrow);
+    ResetScroll();
+}
+
+void VirtualList::RestartFilter(bool narrow) {
+    m_lowerFilter.resize(m_filter.size());
+    std::transform(m_filter.begin(), m_filter.end(), m_lowerFilter.begin(), ToLower);
+
+    if (m_filter.empty()) {
+        m_matches.clear();
+        m_candidates.clear();
+        m_narrowing = false;
+        m_filterPending = false;
+    } else if (narrow && !m_filterPending) {
+        m_candidates.swap(m_matches);
+        m_matches.clear();
+        m_narrowing = true;
+        m_filterPending = true;
+    } else {
+        // Unfinished pass or a shorter filter: scan every item again
+        m_matches.clear();
+        m_candidates.clear();
+        m_narrowing = false;
+        m_filterPending = true;
+    }
+
+    m_scanPosition = 0;
+    m_dirty = true;
+}
+
+void VirtualList::StepFilter() {
+    size_t itemCount = GetItemCount();
+    size_t total = m_narrowing ? m_candidates.size() : itemCount;
+    size_t end = std::min(total, m_scanPosition + kFilterBudget);
+
+    for (size_t i = m_scanPosition; i < end; ++i) {
+        size_t item = m_narrowing ? m_candidates[i] : i;
+        if (item < itemCount && Matches((*m_items)[item])) {
+            m_matches.push_back(static_cast<uint32_t>(item));
+        }
+    }
+
+    m_scanPosition = end;
+    if (end == total) {
+        m_filterPending = false;
+        m_candidates.clear();
+    }
+    m_dirty = true;
+}
+
+bool VirtualList::Matches(std::string_view label) const {
+    auto it = std::search(label.begin(), label.end(), m_lowerFilter.begin(), m_lowerFilter.end(),
+                          [](char a, char b) { return ToLower(a) == b; });
+    return it != label.end() || m_lowerFilter.empty();
+}
+
+size_t VirtualList::GetMatchCount() const {
+    return m_filter.empty() ? GetItemCount() : m_matches.size();
+}
+
+size_t VirtualList::GetItemAt(size_t row) const {
+    return m_filter.empty() ? row : m_matches[row];
+}
+
+size_t VirtualList::GetFirstVisibleRow() const {
+    return static_cast<size_t>(m_scroll) / static_cast<size_t>(m_rowHeight);
+}
+
+float VirtualList::GetMaxScroll() const {
+    float content = static_cast<float>(GetMatchCount()) * m_rowHeight;
+    return std::max(0.0f, content - GetListHeight());
+}
+
+void VirtualList::ResetScroll() {
+    // A new filter result starts at its first match
+    m_scroll = 0.0f;
+    m_velocity = 0.0f;
+}
+
+void VirtualList::ScrollRows(float rows) {
+    m_velocity += rows * m_rowHeight * kFriction;
+}
+
+void VirtualList::ScrollPages(float pages) {
+    ScrollRows(pages * static_cast<float>(std::max(GetListHeight() / m_rowHeight - 1, 1)));
+}
+
+void VirtualList::Update(float deltaTime) {
+    if (m_velocity == 0.0f) {
+        return;
+    }
+
+    // Exact integration of exponential decay, so the glide is frame-rate independent
+    float decay = std::exp(-kFriction * deltaTime);
+    m_scroll += m_velocity * (1.0f - decay) / kFriction;
+    m_velocity *= decay;
+
+    float maxScroll = GetMaxScroll();
+    if (m_scroll <= 0.0f || m_scroll >= maxScroll) {
+        m_scroll = std::clamp(m_scroll, 0.0f, maxScroll);
+        m_velocity = 0.0f;
+    }
+    if (std::fabs(m_velocity) < kStopVelocity) {
+        m_velocity = 0.0f;
+    }
+}
+
+bool VirtualList::IsDirty() const {
+    return m_dirty || static_cast<int>(m_scroll) != m_builtScroll || GetMatchCount() != m_builtMatches;
+}
+
+void VirtualList::Build(DrawList& list) {
+    m_scroll = std::clamp(m_scroll, 0.0f, GetMaxScroll());
+    size_t matchCount = GetMatchCount();
+    int lineHeight = m_text.GetLineHeight();
+    int x = m_bounds.x;
+    int width = m_bounds.w;
+    int rowGap = m_rowHeight / 6;
+    int headerGap = m_padding / 2;
+
+    list.Clear();
+
+    // Header: filter text and match count
+    SDL_Rect headerClip = {x, m_bounds.y, width, m_headerHeight - headerGap};
+    list.SetClipRect(&headerClip);
+    list.AddRect(x, m_bounds.y, width, m_headerHeight - headerGap, kHeaderColor);
+    int headerTextY = m_bounds.y + (m_headerHeight - headerGap - lineHeight) / 2;
+    if (m_filter.empty()) {
+        list.AddText("Type to filter", x + m_padding, headerTextY, kDimTextColor);
+    } else {
+        list.AddText(m_filter, x + m_padding, headerTextY, kTextColor);
+        list.AddRect(x + m_padding + m_text.MeasureText(m_filter).x, headerTextY, std::max(m_padding / 4, 1), lineHeight - 2, kAccentColor);
+    }
+
+    char countText[48];
+    int length = std::snprintf(countText, sizeof(countText), m_filterPending ? "%zu/%zu..." : "%zu/%zu",
+                               matchCount, GetItemCount());
+    std::string_view count(countText, length > 0 ? static_cast<size_t>(length) : 0);
+    list.AddText(count, x + width - m_padding - m_text.MeasureText(count).x, headerTextY, kDimTextColor);
+
+    // Rows: only the visible window, clipped to the list area
+    int top = m_bounds.y + m_headerHeight;
+    int listHeight = GetListHeight();
+    SDL_Rect clip = {x, top, width, listHeight};
+    list.SetClipRect(&clip);
+
+    int rowWidth = width - m_scrollbarWidth - m_padding / 2;
+    size_t maxChars = static_cast<size_t>(std::max((rowWidth - 2 * m_padding) / m_text.GetCharWidth(), 0));
+    size_t first = GetFirstVisibleRow();
+    int offset = static_cast<int>(m_scroll) - static_cast<int>(first) * m_rowHeight;
+
+    for (size_t k = 0; k < m_rows.size() && first + k < matchCount; ++k) {
+        size_t rowIndex = first + k;
+        size_t item = GetItemAt(rowIndex);
+
+        // Consecutive rows land in distinct slots; a slot keeps its state
+        // while the same item stays on screen
+        Row& row = m_rows[rowIndex % m_rows.size()];
+        if (row.item != item) {
+            row.item = item;
+            row.label = (*m_items)[item].substr(0, maxChars);
+        }
+
+        int y = top + static_cast<int>(k) * m_rowHeight - offset;
+        list.AddRect(x, y, rowWidth, m_rowHeight - rowGap, kRowColor);
+        list.AddText(row.label, x + m_padding, y + (m_rowHeight - rowGap - lineHeight) / 2, kTextColor);
+    }
+
+    if (matchCount == 0) {
+        const char* message = m_filterPending ? "Filtering..." :
+                              m_filter.empty() ? "No APKs installed" : "No matches";
+        list.AddText(message, x + m_padding, top + m_padding, kDimTextColor);
+    }
+    list.SetClipRect(nullptr);
+
+    // Scrollbar
+    float contentHeight = static_cast<float>(matchCount) * m_rowHeight;
+    if (contentHeight > listHeight) {
+        int thumbHeight = std::max(20, static_cast<int>(listHeight * listHeight / contentHeight));
+        int thumbY = top + static_cast<int>((listHeight - thumbHeight) * (m_scroll / GetMaxScroll()));
+        list.AddRect(x + width - m_scrollbarWidth, top, m_scrollbarWidth, listHeight, kRowColor);
+        list.AddRect(x + width - m_scrollbarWidth, thumbY, m_scrollbarWidth, thumbHeight, kAccentColor);
+    }
+
+    m_builtScroll = static_cast<int>(m_scroll);
+    m_builtMatches = matchCount;
+    m_dirty = false;
+}
@@ -0,0 +1,235 @@
+#include "ZipArchive.h"
+#include "Inflate.h"
+#include <iostream>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t kEndOfCentralDirSig = 0x06054b50;
+constexpr uint32_t kZip64EndOfCentralDirSig = 0x06064b50;
+constexpr uint32_t kZip64LocatorSig = 0x07064b50;
+constexpr uint32_t kCentralDirEntrySig = 0x02014b50;
+constexpr uint32_t kLocalHeaderSig = 0x04034b50;
+
+constexpr size_t kEndOfCentralDirSize = 22;
+constexpr size_t kZip64LocatorSize = 20;
+constexpr size_t kZip64EndOfCentralDirSize = 56;
+constexpr size_t kCentralDirEntrySize = 46;
+constexpr size_t kLocalHeaderSize = 30;
+constexpr size_t kMaxCommentSize = 0xffff;
+
+// Inflation limits, checked before the output buffer is allocated. DEFLATE
+// cannot expand more than 1032:1 (a 258-byte match per 2 bits), and no
+// manifest or resource table comes near 256 MB.
+constexpr uint64_t kMaxDeflateRatio = 1032;
+constexpr uint64_t kMaxInflatedSize = 256ull * 1024 * 1024;
+
+constexpr uint16_t kZip64ExtraId = 0x0001;
+constexpr uint16_t kFlagEncrypted = 0x0001;
+
+} // namespace
+
+ZipArchive::ZipArchive() {
+}
+
+ZipArchive::~ZipArchive() {
+    Close();
+}
+
+bool ZipArchive::Open(const std::string& filepath) {
+    Close();
+
+    if (!m_file.Open(filepath)) {
+        return false;
+    }
+
+    if (!ReadCentralDirectory()) {
+        std::cerr << "Not a valid ZIP archive: " << filepath << std::endl;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void ZipArchive::Close() {
+    m_index.clear();
+    m_entries.clear();
+    m_file.Close();
+}
+
+bool ZipArchive::ReadCentralDirectory() {
+    const uint8_t* data = m_file.GetData();
+    const size_t size = m_file.GetSize();
+    if (size < kEndOfCentralDirSize) {
+        return false;
+    }
+
+    // The EOCD record sits at the very end, followed only by an optional comment,
+    // so only the last 64 KiB ever need to be scanned
+    size_t scanStart = size > kEndOfCentralDirSize + kMaxCommentSize
+        ? size - kEndOfCentralDirSize - kMaxCommentSize : 0;
+    size_t eocd = std::numeric_limits<size_t>::max();
+    for (size_t pos = size - kEndOfCentralDirSize + 1; pos-- > scanStart;) {
+        if (ReadLE32(data + pos) == kEndOfCentralDirSig) {
+            eocd = pos;
+            break;
+        }
+    }
+    if (eocd == std::numeric_limits<size_t>::max()) {
+        return false;
+    }
+
+    uint64_t entryCount = ReadLE16(data + eocd + 10);
+    uint64_t cdSize = ReadLE32(data + eocd + 12);
+    uint64_t cdOffset = ReadLE32(data + eocd + 16);
+
+    // ZIP64 archives (> 4 GiB or > 65535 entries) carry the real values in a separate record
+    if (eocd >= kZip64LocatorSize && ReadLE32(data + eocd - kZip64LocatorSize) == kZip64LocatorSig) {
+        uint64_t zip64Offset = ReadLE64(data + eocd - kZip64LocatorSize + 8);
+        if (size < kZip64EndOfCentralDirSize || zip64Offset > size - kZip64EndOfCentralDirSize ||
+            ReadLE32(data + zip64Offset) != kZip64EndOfCentralDirSig) {
+            return false;
+        }
+        const uint8_t* rec = data + zip64Offset;
+        entryCount = ReadLE64(rec + 32);
+        cdSize = ReadLE64(rec + 40);
+        cdOffset = ReadLE64(rec + 48);
+    }
+
+    if (cdOffset > size || cdSize > size - cdOffset) {
+        return false;
+    }
+    // Every entry takes at least the fixed header, which bounds a corrupt count
+    if (entryCount > cdSize / kCentralDirEntrySize) {
+        return false;
+    }
+
+    m_entries.reserve(static_cast<size_t>(entryCount));
+    m_index.reserve(static_cast<size_t>(entryCount));
+
+    const uint8_t* cd = data + cdOffset;
+    const uint8_t* cdEnd = cd + cdSize;
+    for (uint64_t i = 0; i < entryCount; ++i) {
+        if (static_cast<size_t>(cdEnd - cd) < kCentralDirEntrySize || ReadLE32(cd) != kCentralDirEntrySig) {
+            return false;
+        }
+
+        uint16_t nameLen = ReadLE16(cd + 28);
+        uint16_t extraLen = ReadLE16(cd + 30);
+        uint16_t commentLen = ReadLE16(cd + 32);
+        size_t recordSize = kCentralDirEntrySize + nameLen + extraLen + commentLen;
+        if (static_cast<size_t>(cdEnd - cd) < recordSize) {
+            return false;
+        }
+
+        ZipEntry entry;
+        entry.name = std::string_view(reinterpret_cast<const char*>(cd + kCentralDirEntrySize), nameLen);
+        entry.flags = ReadLE16(cd + 8);
+        entry.method = ReadLE16(cd + 10);
+        entry.crc32 = ReadLE32(cd + 16);
+        entry.compressedSize = ReadLE32(cd + 20);
+        entry.uncompressedSize = ReadLE32(cd + 24);
+        entry.localHeaderOffset = ReadLE32(cd + 42);
+
+        // ZIP64 extra field: only the saturated 32-bit fields are present, in this order
+        const uint8_t* extra = cd + kCentralDirEntrySize + nameLen;
+        const uint8_t* extraEnd = extra + extraLen;
+        while (extraEnd - extra >= 4) {
+            uint16_t id = ReadLE16(extra);
+            uint16_t len = ReadLE16(extra + 2);
+            const uint8_t* field = extra + 4;
+            if (extraEnd - field < len) {
+                break;
+            }
+            if (id == kZip64ExtraId) {
+                const uint8_t* fieldEnd = field + len;
+                if (entry.uncompressedSize == 0xffffffffu && fieldEnd - field >= 8) {
+                    entry.uncompressedSize = ReadLE64(field);
+                    field += 8;
+                }
+                if (entry.compressedSize == 0xffffffffu && fieldEnd - field >= 8) {
+                    entry.compressedSize = ReadLE64(field);
+                    field += 8;
+                }
+                if (entry.localHeaderOffset == 0xffffffffu && fieldEnd - field >= 8) {
+                    entry.localHeaderOffset = ReadLE64(field);
+                }
+                break;
+            }
+            extra = field + len;
+        }
+
+        m_index.emplace(entry.name, m_entries.size());
+        m_entries.push_back(entry);
+        cd += recordSize;
+    }
+
+    return true;
+}
+
+const ZipEntry* ZipArchive::FindEntry(std::string_view name) const {
+    auto it = m_index.find(name);
+    if (it != m_index.end()) {
+        return &m_entries[it->second];
+    }
+    return nullptr;
+}
+
+ByteView ZipArchive::GetRawData(const ZipEntry& entry) const {
+    const uint8_t* data = m_file.GetData();
+    const size_t size = m_file.GetSize();
+
+    // The local header repeats the name and has its own extra field length,
+    // which may differ from the central directory copy
+    if (entry.localHeaderOffset > size || size - entry.localHeaderOffset < kLocalHeaderSize) {
+        return {};
+    }
+    const uint8_t* local = data + entry.localHeaderOffset;
+    if (ReadLE32(local) != kLocalHeaderSig) {
+        return {};
+    }
+
+    uint64_t dataOffset = entry.localHeaderOffset + kLocalHeaderSize + ReadLE16(local + 26) + ReadLE16(local + 28);
+    if (dataOffset > size || entry.compressedSize > size - dataOffset) {
+        return {};
+    }
+    return {data + dataOffset, static_cast<size_t>(entry.compressedSize)};
+}
+
+bool ZipArchive::ReadEntry(const ZipEntry& entry, std::vector<uint8_t>& scratch, ByteView& out) const {
+    if (entry.flags & kFlagEncrypted) {
+        return false;
+    }
+
+    ByteView raw = GetRawData(entry);
+    if (!raw.data && entry.compressedSize != 0) {
+        return false;
+    }
+
+    if (entry.method == 0) {
+        if (entry.compressedSize != entry.uncompressedSize) {
+            return false;
+        }
+        out = raw;
+        return true;
+    }
+
+    if (entry.method == 8) {
+        // The sizes come from the archive; don't let them pick the allocation
+        if (entry.uncompressedSize > kMaxInflatedSize ||
+            entry.uncompressedSize > raw.size * kMaxDeflateRatio) {
+            return false;
+        }
+        scratch.resize(static_cast<size_t>(entry.uncompressedSize));
+        size_t written = 0;
+        if (!InflateRaw(raw.data, raw.size, scratch.data(), scratch.size(), &written) ||
+            written != scratch.size()) {
+            return false;
+        }
+        out = {scratch.data(), scratch.size()};
+        return true;
+    }
+
+    // Other compression methods are not used by APK tooling
+    return false;
+}
@@ -2,21 +2,170 @@
 #include <SDL.h>
 
 #include "Emulator.h"
+#include "Benchmarks.h"
+#include "Profiler.h"
+#include "StartupTrace.h"
 #include <iostream>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <exception>
+#include <string>
+
+namespace {
+
+// A positive whole number no larger than 'maxValue'; false for anything else
+bool ParseCount(const char* text, long long maxValue, long long& count) {
+    char* end = nullptr;
+    errno = 0;
+    long long value = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || value <= 0 || value > maxValue) {
+        return false;
+    }
+    count = value;
+    return true;
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
+    // Everything before this mark is process creation and DLL loading
+    StartupTrace::SetThreadName("main");
+    Profiler::SetThreadName("main");
+    StartupTrace::AddMark("main");
+    
+    // Benchmark modes run without the emulator window
+    if (argc >= 3 && std::string(argv[1]) == "--bench-scan") {
+        return Benchmarks::RunAPKScan(argv[2]);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--bench-list") {
+        long long entries = 50000;
+        if (argc >= 3 && !ParseCount(argv[2], INT_MAX, entries)) {
+            std::cerr << "Usage: Emulator --bench-list [entries]" << std::endl;
+            return 1;
+        }
+        return Benchmarks::RunVirtualList(static_cast<size_t>(entries));
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--bench-upload") {
+        long long frames = 300;
+        if (argc >= 3 && !ParseCount(argv[2], INT_MAX, frames)) {
+            std::cerr << "Usage: Emulator --bench-upload [frames]" << std::endl;
+            return 1;
+        }
+        return Benchmarks::RunGuestUpload(static_cast<int>(frames));
+    }
+
+    // Allocation self-check of the real frame path, on SDL's windowless video driver
+    bool checkAllocations = argc >= 2 && std::string(argv[1]) == "--check-frame-allocs";
+    long long checkFrames = 600;
+    if (checkAllocations && argc >= 3 && !ParseCount(argv[2], INT_MAX, checkFrames)) {
+        std::cerr << "Usage: Emulator --check-frame-allocs [frames]" << std::endl;
+        return 1;
+    }
+    
+    // Headless run of the full frame loop for benchmarks and CI: windowless video
+    // driver, software renderer, no vsync. SDL_VIDEODRIVER in the environment
+    // (e.g. "offscreen") takes precedence over the dummy driver. '--inject [script]'
+    // adds synthetic key presses and reports their latency to present.
+    bool headless = argc >= 2 && std::string(argv[1]) == "--headless";
+    
+    // Replay of an input recording ('--record <file>' records any run): windowed
+    // unless '--headless', paced as recorded unless '--fast'
+    bool replay = argc >= 3 && std::string(argv[1]) == "--replay";
+    
+    bool hashFrames = false;
+    bool injectInput = false;
+    bool fastReplay = false;
+    bool windowless = headless;
+    std::string inputScript;    // Empty: the built-in script
+    std::string recordPath;
+    std::string startupTracePath;
+    int headlessFrames = 1000;
+    for (int i = headless ? 2 : replay ? 3 : 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--trace-startup") {
+            // Any run mode: phase timings up to the first frame and the loaded
+            // catalog. The path is optional, so it must end in .json.
+            startupTracePath = "startup_trace.json";
+            std::string next = i + 1 < argc ? argv[i + 1] : "";
+            if (next.size() > 5 && next.compare(next.size() - 5, 5, ".json") == 0) {
+                startupTracePath = argv[++i];
+            }
+        } else if (arg == "--hash") {
+            hashFrames = true;
+        } else if (headless && arg == "--inject") {
+            injectInput = true;
+            if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                inputScript = argv[++i];
+            }
+        } else if (replay && arg == "--fast") {
+            fastReplay = true;
+        } else if (replay && arg == "--headless") {
+            windowless = true;
+        } else if (headless) {
+            long long frames = 0;
+            if (!ParseCount(arg.c_str(), INT_MAX, frames)) {
+                std::cerr << "Error: '" << arg << "' is not a frame count" << std::endl;
+                std::cerr << "Usage: Emulator --headless [frames] [--hash] [--inject [script]] "
+                             "[--record <file>] [--trace-startup [file.json]]" << std::endl;
+                return 1;
+            }
+            headlessFrames = static_cast<int>(frames);
+        }
+    }
+    if (windowless) {
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+        SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+    }
+    
+    if (checkAllocations || windowless) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    }
 
     try {
         Emulator emulator;
 
+        if (replay && !emulator.LoadReplay(argv[2])) {
+            return 1;
+        }
+        if (!startupTracePath.empty()) {
+            emulator.SetStartupTracePath(startupTracePath);
+        }
+
         if (!emulator.Initialize()) {
             std::cerr << "Failed to initialize emulator!" << std::endl;
             return 1;
         }
 
+        if (!recordPath.empty() && !emulator.StartRecording(recordPath)) {
+            emulator.Shutdown();
+            return 1;
+        }
+
+        if (checkAllocations) {
+            int result = emulator.RunAllocationCheck(static_cast<int>(checkFrames));
+            emulator.Shutdown();
+            return result;
+        }
+        
+        if (headless) {
+            if (injectInput && !emulator.LoadInputScript(inputScript)) {
+                emulator.Shutdown();
+                return 1;
+            }
+            int result = emulator.RunHeadless(headlessFrames, hashFrames);
+            emulator.Shutdown();
+            return result;
+        }
+        
+        if (replay) {
+            int result = emulator.RunReplay(fastReplay, hashFrames);
+            emulator.Shutdown();
+            return result;
+        }
+
         emulator.Run();
         emulator.Shutdown();
 